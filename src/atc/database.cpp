@@ -18,6 +18,7 @@
  */
 
 #include "database.h"
+#include "thermodynamics.h"
 #include "utilities.h"
 #include <stdexcept>
 #include <QtSql/QSqlQuery>
@@ -182,6 +183,27 @@ QSqlQuery Query(const QString& query, const QString& name)
 
 } // SQL
 
+Phase ToPhase(const QString& phase)
+{
+	if(phase == QStringLiteral("G")) {
+		return Phase::Gas;
+	} else if(phase == QStringLiteral("L")) {
+		return Phase::Liquid;
+	} else {
+		return Phase::Solid;
+	}
+}
+
+QString ToString(const Phase phase)
+{
+	switch(phase) {
+	case Phase::Solid:	return QStringLiteral("S");
+	case Phase::Liquid:	return QStringLiteral("L");
+	case Phase::Gas:	return QStringLiteral("G");
+	}
+	return QString{};
+}
+
 Database::Database(const QString& filename)
 {
 	database_name = filename;
@@ -246,8 +268,9 @@ SubstanceTempRangeData Database::GetSubstanceTempRangeData(const int id)
 									 q.value(8).toDouble(), // f5
 									 q.value(9).toDouble(), // f6
 									 q.value(10).toDouble(), // f7
-								 q.value(11).toString().toUpper()}); // phase
+								 ToPhase(q.value(11).toString().toUpper())}); // phase
 	}
+	PrepareTempRangeData(data);
 	return data;
 }
 
@@ -269,7 +292,10 @@ SubstancesTempRangeData Database::GetSubstancesTempRangeData(const QString& ids)
 									   q.value(9).toDouble(), // f5
 									   q.value(10).toDouble(), // f6
 									   q.value(11).toDouble(), // f7
-								   q.value(12).toString().toUpper()}); // phase
+								   ToPhase(q.value(12).toString().toUpper())}); // phase
+	}
+	for(auto&& item : tr) {
+		PrepareTempRangeData(item.second);
 	}
 	return tr;
 }
@@ -327,3 +353,7 @@ QString Database::GetPhasesString(const ParametersNS::ShowPhases& phases)
 	}
 }
 
+void DatabaseHSC::PrepareTempRangeData(SubstanceTempRangeData& data) const
+{
+	Thermodynamics::HSC::MakeIntegrationConstants(data);
+}
@@ -61,10 +61,20 @@ struct SubstanceData : SubstanceWeight
 };
 using SubstancesData = QVector<SubstanceData>;
 
+enum class Phase {
+	Solid,	// "S" or empty in the databases
+	Liquid,	// "L"
+	Gas		// "G"
+};
+Phase ToPhase(const QString& phase);
+QString ToString(const Phase phase);
+
 struct TempRangeData
 {
 	double T_min, T_max, H, S, f1, f2, f3, f4, f5, f6, f7;
-	QString phase;
+	Phase phase;
+	// HSC: integration constants of H and S for T below and above T0
+	double H_below{0}, H_above{0}, S_below{0}, S_above{0};
 };
 using SubstanceTempRangeData = QVector<TempRangeData>;
 // int = substance ID
@@ -112,6 +122,7 @@ protected:
 	virtual const QString& GetSubstanceTempRangeDataString() const = 0;
 	virtual const QString& GetSubstancesTempRangeDataString() const = 0;
 	virtual const QString& GetSubstanceNameString() const = 0;
+	virtual void PrepareTempRangeData(SubstanceTempRangeData&) const {}
 	QString GetPhasesString(const ParametersNS::ShowPhases& phases);
 };
 
@@ -167,6 +178,7 @@ protected:
 	const QString& GetSubstanceNameString() const override {
 		return SQL::hsc_substance_name_template;
 	}
+	void PrepareTempRangeData(SubstanceTempRangeData& data) const override;
 };
 
 #endif // DATABASE_H
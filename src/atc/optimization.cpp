@@ -19,6 +19,11 @@
 
 #include "optimization.h"
 #include "thermodynamics.h"
+#include "simd.h"
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <numbers>
 
 #ifndef NDEBUG
 std::atomic_int32_t i_maker{0};
@@ -30,6 +35,24 @@ std::atomic_int32_t i_items{0};
 #endif
 
 namespace Optimization {
+// The nlopt object is reused by all calls with the same algorithm, function
+// and dimensions on the thread. The objective and the constraints get
+// the address of the item slot, so only the slot and bounds are updated.
+struct Solver
+{
+	nlopt::algorithm algorithm;
+	nlopt::vfunc function;
+	size_t substances;
+	size_t elements;
+	const OptimizationItem* item{nullptr};
+	// Jacobian of the constraints is the A matrix, it is constant during
+	// the optimization, so the buffer of nlopt is filled only once
+	const double* jacobian{nullptr};
+	nlopt::opt opt;
+	Solver(const nlopt::algorithm algorithm_, const nlopt::vfunc function_,
+		   const size_t substances_, const size_t elements_);
+};
+
 constexpr static double epsilon_log = 1E-9;
 constexpr static double epsilon_accuracy = 1E-6;
 constexpr static double maxtime_of_minimize = 1; // second
@@ -39,64 +62,217 @@ static double Log_eps(const double x) // noexcept
 	return ((std::log(x*x + epsilon_log)) / 2);
 }
 
-static double ConstraintFunction(const std::vector<double>& x,
-								 std::vector<double>& grad, void* data)
+// std::isfinite is folded to true by -ffast-math of the release build,
+// the exponent of inf and nan has all bits set
+static bool IsFinite(const double x) noexcept
+{
+	constexpr std::uint64_t exponent = 0x7FF0000000000000;
+	return (std::bit_cast<std::uint64_t>(x) & exponent) != exponent;
+}
+
+static void ConstraintsFunction(unsigned m, double* result, unsigned n,
+								const double* x, double* grad, void* data)
 {
-	const Constraint* cnt = reinterpret_cast<const Constraint*>(data);
-	if(!grad.empty()) {
-		assert(cnt->a_j.size() == grad.size() && "grad.size error");
-		std::copy(cnt->a_j.cbegin(), cnt->a_j.cend(), grad.begin());
+	// result = A * x - b, grad = A
+	Solver* solver = reinterpret_cast<Solver*>(data);
+	auto&& a = solver->item->GetA();
+	auto&& b = solver->item->GetB();
+	assert(a.size() == size_t{m} * n && b.size() == m && "A or b size error");
+	for(unsigned j = 0; j != m; ++j) {
+		const double* a_j = a.data() + size_t{j} * n;
+		double r = -b[j];
+		for(unsigned k = 0; k != n; ++k) {
+			r += a_j[k] * x[k];
+		}
+		result[j] = r;
+	}
+	if(grad && grad != solver->jacobian) {
+		std::copy(a.cbegin(), a.cend(), grad);
+		solver->jacobian = grad;
 	}
-	assert(x.size() == cnt->a_j.size() && "x.size error");
-	return std::transform_reduce(x.cbegin(), x.cend(), cnt->a_j.cbegin(),
-								 -cnt->b_j); /* minus of bj */
 }
 
-static double ThermodinamicFunction(const std::vector<double>& n,
-									std::vector<double>& grad, void* data)
+#ifdef __AVX2__
+static __m256d Log_eps(const __m256d x)
+{
+	const __m256d y = Simd::MulAdd(x, x, _mm256_set1_pd(epsilon_log));
+	return _mm256_mul_pd(Simd::Log(y), _mm256_set1_pd(0.5));
+}
+#endif
+
+// Sum of n_k * (c_k + Log_eps(n_k) - ls) over the phase in one pass,
+// the values in the brackets are the gradient, it is written if grad != null
+static double MixtureTerm(const double* n, const double* c, double* grad,
+						  const size_t size, const double ls)
 {
-	using DT = std::vector<double>::difference_type;
-	const OptimizationItem* tcn = reinterpret_cast<const OptimizationItem*>(data);
-	auto&& c = tcn->GetC();
-	auto&& numbers = tcn->GetNumbers();
-	auto n_gas = n.cbegin();
-	auto n_liq = std::next(n_gas, static_cast<DT>(numbers.gases));
-	auto n_ind = std::next(n_liq, static_cast<DT>(numbers.liquids));
-	auto c_gas = c.cbegin();
-	auto c_liq = std::next(c_gas, static_cast<DT>(numbers.gases));
-	auto c_ind = std::next(c_liq, static_cast<DT>(numbers.liquids));
-	double lsg = Log_eps(std::accumulate(n_gas, n_liq, double{0.0}));
-	double lsl = Log_eps(std::accumulate(n_liq, n_ind, double{0.0}));
+	size_t k = 0;
 	double result{0.0};
-	if(grad.empty()) {
+#ifdef __AVX2__
+	const __m256d ls4 = _mm256_set1_pd(ls);
+	__m256d sum = _mm256_setzero_pd();
+	for(; k + 4 <= size; k += 4) {
+		const __m256d n4 = _mm256_loadu_pd(n + k);
+		const __m256d g4 = _mm256_sub_pd(
+				_mm256_add_pd(_mm256_loadu_pd(c + k), Log_eps(n4)), ls4);
+		if(grad) {
+			_mm256_storeu_pd(grad + k, g4);
+		}
+		sum = Simd::MulAdd(n4, g4, sum);
+	}
+	result = Simd::HorizontalSum(sum);
+#endif
+	for(; k != size; ++k) {
+		const double g = c[k] + Log_eps(n[k]) - ls;
+		if(grad) {
+			grad[k] = g;
+		}
+		result += n[k] * g;
+	}
+	return result;
+}
+
+// Sum of n_k * c_k with the ideal mixing of the gas and the liquid solution,
+// n and c are in the order |gas|liq|ind|. The constant moles of other blocks
+// in the mixtures add -N_other * ln(N), the gradient stays c_k + ln(n_k / N).
+template<typename Numbers>
+static double PhasesFunction(const double* n, const double* c, double* grad,
+							 const Numbers& numbers, const double gas_other = 0,
+							 const double liquid_other = 0)
+{
+	const double* n_gas = n;
+	const double* n_liq = n_gas + numbers.gases;
+	const double* n_ind = n_liq + numbers.liquids;
+	const double* c_gas = c;
+	const double* c_liq = c_gas + numbers.gases;
+	const double* c_ind = c_liq + numbers.liquids;
+	double* grad_gas = grad;
+	double* grad_liq = grad ? grad_gas + numbers.gases : nullptr;
+	double lsg = Log_eps(std::accumulate(n_gas, n_liq, gas_other));
+	double lsl = Log_eps(std::accumulate(n_liq, n_ind, liquid_other));
+	double result = MixtureTerm(n_gas, c_gas, grad_gas, numbers.gases, lsg);
+	result += MixtureTerm(n_liq, c_liq, grad_liq, numbers.liquids, lsl);
+	result -= gas_other * lsg + liquid_other * lsl;
+	if(!grad) {
 		LOGV("grad.empty()")
-		result = std::transform_reduce(n_gas, n_liq, c_gas, double{0.0},
-									   std::plus<>(), [lsg](auto ni, auto ci){
-			return ni * (ci + Log_eps(ni) - lsg);});
-		result = std::transform_reduce(n_liq, n_ind, c_liq, result,
-									   std::plus<>(), [lsl](auto ni, auto ci){
-			return ni * (ci + Log_eps(ni) - lsl);});
-		result = std::transform_reduce(n_ind, n.end(), c_ind, result);
 	} else {
 		LOGV("!grad.empty()")
-		auto grad_gas = grad.begin();
-		auto grad_liq = std::next(grad_gas, static_cast<DT>(numbers.gases));
-		auto grad_ind = std::next(grad_liq, static_cast<DT>(numbers.liquids));
-		std::transform(n_gas, n_liq, c_gas, grad_gas, [lsg](auto ni, auto ci){
-			return ci + Log_eps(ni) - lsg;});
-		std::transform(n_liq, n_ind, c_liq, grad_liq, [lsl](auto ni, auto ci){
-			return ci + Log_eps(ni) - lsl;});
-		std::copy(c_ind, c.end(), grad_ind);
-		result = std::transform_reduce(n_gas, n.cend(), grad_gas, double{0.0});
+		std::copy(c_ind, c_ind + numbers.individuals, grad_liq + numbers.liquids);
 	}
+	result = std::transform_reduce(n_ind, n_ind + numbers.individuals, c_ind, result);
 	return result;
 }
+
+static double ThermodinamicFunction(const std::vector<double>& n,
+									std::vector<double>& grad, void* data)
+{
+	// data points to the slot of the item in the Solver
+	const OptimizationItem* tcn = *reinterpret_cast<const OptimizationItem* const*>(data);
+	return PhasesFunction(n.data(), tcn->GetC().data(),
+						  grad.empty() ? nullptr : grad.data(), tcn->GetNumbers(),
+						  tcn->gas_of_other_blocks, tcn->liquid_of_other_blocks);
+}
 static double ThermodinamicFunctionMinus(const std::vector<double>& n,
 									std::vector<double>& grad, void* data)
 {
 	return -ThermodinamicFunction(n, grad, data);
 }
 
+// Database models, Substance() evaluates one substance, Interval() all
+// substances of the interval in the order of the ordering
+struct ThermoModel
+{
+	static Thermodynamics::Properties Substance(const double temperature_K,
+												const SubstanceTempRangeData& coefs)
+	{
+		return Thermodynamics::Thermo::TF_Properties(temperature_K, coefs);
+	}
+	static void Interval(const double temperature_K, const ProblemContext&,
+						 const TemperatureInterval& interval, const Ordering&,
+						 Thermodynamics::PropertiesBlock& properties)
+	{
+		Thermodynamics::Thermo::TF_Properties(temperature_K, interval.block,
+											  properties);
+	}
+};
+
+struct HSCModel
+{
+	static Thermodynamics::Properties Substance(const double temperature_K,
+												const SubstanceTempRangeData& coefs)
+	{
+		return Thermodynamics::HSC::TF_Properties(temperature_K, coefs);
+	}
+	static void Interval(const double temperature_K, const ProblemContext& context,
+						 const TemperatureInterval&, const Ordering& ordering,
+						 Thermodynamics::PropertiesBlock& properties)
+	{
+		for(size_t k = 0, size = ordering.order.size(); k != size; ++k) {
+			properties.Set(k, Substance(temperature_K,
+					*context.substance_coefs[ordering.order[k]]));
+		}
+	}
+};
+
+// Minimization functions, c of the objective is taken from the properties
+struct GibbsEnergyObjective
+{
+	static constexpr auto c = &Thermodynamics::PropertiesBlock::c;
+	static constexpr nlopt::vfunc function = ThermodinamicFunction;
+	static constexpr double sign = 1;	// of c in the minimized function
+};
+
+// the sum of n_k * S_k with the mixing terms of the Gibbs energy is maximized
+struct EntropyObjective
+{
+	static constexpr auto c = &Thermodynamics::PropertiesBlock::S_J;
+	static constexpr nlopt::vfunc function = ThermodinamicFunctionMinus;
+	static constexpr double sign = -1;
+};
+
+// Kernels of the calculation are function pointers chosen once in
+// ProblemContext by the database and the minimization function, so there
+// is one indirect call per interval or objective instead of the switches.
+// Other coefficient formats need a model like ThermoModel and a case
+// in SelectKernels.
+struct Kernels
+{
+	Thermodynamics::Properties (*substance)(const double temperature_K,
+											const SubstanceTempRangeData& coefs);
+	void (*interval)(const double temperature_K, const ProblemContext& context,
+					 const TemperatureInterval& interval, const Ordering& ordering,
+					 Thermodynamics::PropertiesBlock& properties);
+	std::vector<double> Thermodynamics::PropertiesBlock::* c;
+	nlopt::vfunc objective;
+	double sign;
+};
+
+template<typename Model, typename Objective>
+constexpr Kernels kernels{Model::Substance, Model::Interval, Objective::c,
+						  Objective::function, Objective::sign};
+
+template<typename Model>
+static const Kernels* SelectKernels(const ParametersNS::MinimizationFunction function)
+{
+	switch(function) {
+	case ParametersNS::MinimizationFunction::GibbsEnergy:
+		return &kernels<Model, GibbsEnergyObjective>;
+	case ParametersNS::MinimizationFunction::Entropy:
+		return &kernels<Model, EntropyObjective>;
+	}
+	throw std::logic_error("out of range in switch");
+}
+
+static const Kernels* SelectKernels(const ParametersNS::Parameters& parameters)
+{
+	switch(parameters.database) {
+	case ParametersNS::Database::Thermo:
+		return SelectKernels<ThermoModel>(parameters.minimization_function);
+	case ParametersNS::Database::HSC:
+		return SelectKernels<HSCModel>(parameters.minimization_function);
+	}
+	throw std::logic_error("out of range in switch");
+}
+
 #ifndef NDEBUG
 static const char* NLoptResultToString(nlopt::result result)
 {
@@ -119,10 +295,682 @@ static const char* NLoptResultToString(nlopt::result result)
 }
 #endif
 
-auto OptimizationItemsMaker::MakeNewAmounts(const Composition& amounts,
-											const SubstanceWeights& weights)
+// The ratio r > 0 if the substance k is r times the substance other
+// by the composition, else 0. A is M x N by rows.
+static double CompositionRatio(const double* a, const size_t M, const size_t N,
+							   const size_t k, const size_t other)
+{
+	double ratio = 0;
+	for(size_t j = 0; j != M && ratio == 0; ++j) {
+		if(a[j * N + other] != 0) {
+			ratio = a[j * N + k] / a[j * N + other];
+		}
+	}
+	if(!(ratio > 0)) {
+		return 0;
+	}
+	for(size_t j = 0; j != M; ++j) {
+		const double a_k = a[j * N + k];
+		if(std::abs(a_k - ratio * a[j * N + other]) > 1.0E-12 * std::abs(a_k)) {
+			return 0;
+		}
+	}
+	return ratio;
+}
+
+// Initial temperatures of the items, K, in the order of the workmode
+static std::vector<double> InitialTemperatures(const ParametersNS::Parameters& parameters)
+{
+	switch(parameters.workmode) {
+	case ParametersNS::Workmode::SinglePoint:
+	case ParametersNS::Workmode::CompositionRange:
+		return {Thermodynamics::ToKelvin(parameters.temperature_initial,
+										 parameters.temperature_initial_unit)};
+	case ParametersNS::Workmode::TemperatureRange:
+	case ParametersNS::Workmode::TemperatureCompositionRange: {
+		std::vector<double> temperature;
+		Thermodynamics::RangeTabulator(parameters.temperature_range, temperature);
+		std::transform(temperature.cbegin(), temperature.cend(),
+					   temperature.begin(),
+					   [tu = parameters.temperature_range_unit](double t){
+			return Thermodynamics::ToKelvin(t, tu); });
+		return temperature;
+	}
+	}
+	throw std::logic_error("out of range in switch");
+}
+
+// Temperatures of the equilibria of all items, K. The adiabatic temperature
+// is searched in the whole range of the enthalpy curve.
+static std::pair<double, double> TemperatureSpan(const ParametersNS::Parameters& parameters)
+{
+	const auto Span = [&parameters](const double T_lo, const double T_hi){
+		if(parameters.target == ParametersNS::Target::AdiabaticTemperature) {
+			return std::make_pair(std::min(T_lo, EnthalpyCurve::T_min),
+								  std::max(T_hi, EnthalpyCurve::T_max));
+		}
+		return std::make_pair(T_lo, T_hi);
+	};
+	switch(parameters.workmode) {
+	case ParametersNS::Workmode::SinglePoint:
+	case ParametersNS::Workmode::CompositionRange: {
+		const auto T = Thermodynamics::ToKelvin(parameters.temperature_initial,
+												parameters.temperature_initial_unit);
+		return Span(T, T);
+	}
+	case ParametersNS::Workmode::TemperatureRange:
+	case ParametersNS::Workmode::TemperatureCompositionRange: {
+		const auto start = Thermodynamics::ToKelvin(parameters.temperature_range.start,
+													parameters.temperature_range_unit);
+		const auto stop = Thermodynamics::ToKelvin(parameters.temperature_range.stop,
+												   parameters.temperature_range_unit);
+		return Span(std::min(start, stop), std::max(start, stop));
+	}
+	}
+	throw std::logic_error("out of range in switch");
+}
+
+ProblemContext::ProblemContext(
+		const ParametersNS::Parameters& parameters_,
+		const std::vector<int>& elements_,
+		const SubstancesTempRangeData& temp_ranges_,
+		const SubstancesElementComposition& subs_element_composition_,
+		const SubstanceWeights& weights_,
+		const Composition& amounts_)
+	: parameters{parameters_}
+	, elements{elements_}
+	, temp_ranges{temp_ranges_}
+	, subs_element_composition{subs_element_composition_}
+	, weights{weights_}
+	, amounts{amounts_}
+	, kernels{SelectKernels(parameters_)}
+{
+	assert(std::is_sorted(weights.cbegin(), weights.cend(),
+						  [](const SubstanceWeight& lhs, const SubstanceWeight& rhs){
+			   return lhs.id < rhs.id; }));
+	MakeArrays();
+	if(Prescreen()) {
+		MakeArrays();
+	}
+	MakeIntervals();
+	initial_temperatures = InitialTemperatures(parameters);
+	std::sort(initial_temperatures.begin(), initial_temperatures.end());
+	initial_temperatures.erase(std::unique(initial_temperatures.begin(),
+										   initial_temperatures.end()),
+							   initial_temperatures.end());
+	entries = std::vector<TemperatureEntry>(initial_temperatures.size());
+	if(parameters.surrogate == ParametersNS::Surrogate::Enable &&
+			parameters.target == ParametersNS::Target::AdiabaticTemperature) {
+		surrogate.Make(*this, EnthalpyCurve::T_min, EnthalpyCurve::T_max,
+					   parameters.surrogate_accuracy);
+	}
+}
+
+void ProblemContext::MakeArrays()
+{
+	const auto N = static_cast<size_t>(weights.size());
+	const auto M = elements.size();
+	substance_ids.clear();
+	substance_coefs.clear();
+	substance_ids.reserve(N);
+	substance_coefs.reserve(N);
+	element_matrix.assign(M * N, 0.0);
+	for(const auto& weight : weights) {
+		const auto i = substance_ids.size();
+		substance_ids.push_back(weight.id);
+		substance_coefs.push_back(&temp_ranges.at(weight.id));
+		const auto& sub = subs_element_composition.at(weight.id);
+		for(size_t j = 0; j != M; ++j) {
+			auto element_it = sub.find(elements.at(j));
+			if(element_it != sub.cend()) {
+				element_matrix.at(j * N + i) = element_it->second;
+			}
+		}
+	}
+
+	// the elements are connected by the substances which contain them
+	std::vector<size_t> parent(M);
+	std::iota(parent.begin(), parent.end(), size_t{0});
+	auto root = [&parent](size_t j){
+		while(parent[j] != j) {
+			j = parent[j] = parent[parent[j]];
+		}
+		return j;
+	};
+	for(size_t i = 0; i != N; ++i) {
+		size_t first = M;
+		for(size_t j = 0; j != M; ++j) {
+			if(element_matrix[j * N + i] == 0) {
+				continue;
+			}
+			if(first == M) {
+				first = j;
+			} else {
+				parent[root(j)] = root(first);
+			}
+		}
+	}
+	std::vector<size_t> index(M, M);
+	blocks = 0;
+	element_blocks.resize(M);
+	for(size_t j = 0; j != M; ++j) {
+		const auto r = root(j);
+		if(index[r] == M) {
+			index[r] = blocks++;
+		}
+		element_blocks[j] = index[r];
+	}
+	substance_blocks.assign(N, 0);
+	for(size_t i = 0; i != N; ++i) {
+		for(size_t j = 0; j != M; ++j) {
+			if(element_matrix[j * N + i] != 0) {
+				substance_blocks[i] = element_blocks[j];
+				break;
+			}
+		}
+	}
+}
+
+bool ProblemContext::Prescreen()
+{
+	// The substances without initial amounts are removed if they cannot
+	// appear at the temperatures of the items: they do not exist there
+	// and extrapolation is disabled, or they are individual and their G
+	// is greater than G of r moles of a substance with r times smaller
+	// composition everywhere. The latter is replaced by the former with
+	// lower G, even in a mixture, where its potential is lower than G.
+	constexpr double temperature_step = 5; // K
+	constexpr double epsilon_dominance = 1.0E-6; // of c = G/RT
+	constexpr double epsilon_inside = 1.0E-9; // of T, the coefficients of the step
+	const auto [T_lo, T_hi] = TemperatureSpan(parameters);
+	const auto N = substance_ids.size();
+	const auto M = elements.size();
+	const bool is_extrapolation =
+			parameters.extrapolation == ParametersNS::Extrapolation::Enable;
+	auto exists = [&](const size_t i, const double T){
+		return is_extrapolation || (substance_coefs[i]->cbegin()->T_min <= T &&
+									T <= substance_coefs[i]->crbegin()->T_max);
+	};
+	auto is_individual = [this](const size_t i, const double T){
+		switch(Thermodynamics::FindCoef(T, *substance_coefs[i]).phase) {
+		case Phase::Gas:
+			return false;
+		case Phase::Liquid:
+			return parameters.liquid_solution == ParametersNS::LiquidSolution::No;
+		case Phase::Solid:
+			return true;
+		}
+		return false;
+	};
+	// the edges of the ranges are sampled, G can jump there
+	std::vector<double> temperatures;
+	for(double T = T_lo; T < T_hi; T += temperature_step) {
+		temperatures.push_back(T);
+	}
+	temperatures.push_back(T_hi);
+	for(const auto coefs : substance_coefs) {
+		for(const auto& coef : *coefs) {
+			for(const auto T : {coef.T_min, coef.T_max}) {
+				if(T_lo < T && T < T_hi) {
+					temperatures.push_back(T);
+				}
+			}
+		}
+	}
+	std::sort(temperatures.begin(), temperatures.end());
+	temperatures.erase(std::unique(temperatures.begin(), temperatures.end()),
+					   temperatures.end());
+	if(temperatures.size() == 1) {
+		temperatures.push_back(T_hi);	// the step of zero length
+	}
+	// H_initial by the minimum of G compares the substances
+	// of the same composition even if they do not exist
+	const bool is_h_initial_by_g =
+			parameters.H_initial_by == ParametersNS::H_Initial_By::ByMinimumGibbsEnergy;
+	// c_i - ratio c_k and its derivative -(H_i - ratio H_k) / RT^2
+	auto difference = [&](const size_t i, const size_t k, const double ratio,
+						  const double T, double& derivative){
+		const auto p_i = kernels->substance(T, *substance_coefs[i]);
+		const auto p_k = kernels->substance(T, *substance_coefs[k]);
+		derivative = -(p_i.H_kJ - ratio * p_k.H_kJ) * 1000 /
+				(Thermodynamics::R * T * T);
+		return p_i.c - ratio * p_k.c;
+	};
+	// The coefficients do not change between the samples, the difference
+	// is checked at both ends of each step by the coefficients inside it.
+	// Its derivative changes little on the step, so twice the larger one
+	// at the ends bounds it and the difference stays positive inside if
+	// min(d_a, d_b) > step * max(|d'_a|, |d'_b|).
+	auto is_dominated = [&](const size_t i, const size_t k, const double ratio){
+		for(size_t s = 0; s + 1 < temperatures.size(); ++s) {
+			const double T_a = temperatures[s];
+			const double T_b = temperatures[s + 1];
+			const double T_m = (T_a + T_b) / 2;
+			if(exists(i, T_m)) {
+				if(!exists(k, T_m) || !is_individual(i, T_m)) {
+					return false;
+				}
+			} else if(!is_h_initial_by_g) {
+				continue;
+			}
+			const double delta = std::min(epsilon_inside * T_b, (T_b - T_a) / 4);
+			double derivative_a, derivative_b;
+			const double d_a = difference(i, k, ratio, T_a + delta, derivative_a);
+			const double d_b = difference(i, k, ratio, T_b - delta, derivative_b);
+			const double margin = (T_b - T_a) *
+					std::max(std::abs(derivative_a), std::abs(derivative_b));
+			const double epsilon = epsilon_dominance * (1 + std::abs(d_a) + std::abs(d_b));
+			if(!(std::min(d_a, d_b) > margin + epsilon)) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	std::vector<char> is_pruned(N, 0);
+	for(size_t i = 0; i != N; ++i) {
+		if(!amounts.at(substance_ids[i]).isZero()) {
+			continue;
+		}
+		if(!is_extrapolation && (substance_coefs[i]->crbegin()->T_max < T_lo ||
+								 T_hi < substance_coefs[i]->cbegin()->T_min)) {
+			is_pruned[i] = 1;
+			continue;
+		}
+		// the entropy is not compared
+		if(parameters.minimization_function !=
+				ParametersNS::MinimizationFunction::GibbsEnergy) {
+			continue;
+		}
+		for(size_t k = 0; k != N; ++k) {
+			const double ratio = k == i ? 0.0 :
+					CompositionRatio(element_matrix.data(), M, N, i, k);
+			if(ratio > 0 && is_dominated(i, k, ratio)) {
+				is_pruned[i] = 1;
+				break;
+			}
+		}
+	}
+	if(std::find(is_pruned.cbegin(), is_pruned.cend(), 1) == is_pruned.cend()) {
+		return false;
+	}
+
+	SubstanceWeights kept;
+	for(size_t i = 0; i != N; ++i) {
+		const auto& weight = weights.at(static_cast<int>(i));
+		if(!is_pruned[i]) {
+			kept.push_back(weight);
+			continue;
+		}
+		LOG(weight.formula)
+		pruned.push_back(weight);
+		const auto id = substance_ids[i];
+		temp_ranges.erase(id);
+		subs_element_composition.erase(id);
+		amounts.erase(id);
+	}
+	weights = std::move(kept);
+	return true;
+}
+
+void ProblemContext::MakeIntervals()
+{
+	// FindCoef() changes its choice only at T_min of the first range
+	// and at T_max of each range
+	for(const auto& coefs : substance_coefs) {
+		breakpoints.push_back(coefs->cbegin()->T_min);
+		for(const auto& coef : *coefs) {
+			breakpoints.push_back(coef.T_max);
+		}
+	}
+	std::sort(breakpoints.begin(), breakpoints.end());
+	breakpoints.erase(std::unique(breakpoints.begin(), breakpoints.end()),
+					  breakpoints.end());
+	const auto N = substance_ids.size();
+	const auto M = elements.size();
+	intervals.resize(breakpoints.size() + 1);
+	for(size_t k = 0; k != intervals.size(); ++k) {
+		// any temperature of the interval
+		auto T = k == 0 ? breakpoints.front() - 1 : breakpoints.at(k - 1);
+		Ordering current;
+		std::vector<int> liq, ind;
+		for(int i = 0, size = static_cast<int>(N); i != size; ++i) {
+			switch(Thermodynamics::FindCoef(T, *substance_coefs[i]).phase) {
+			case Phase::Gas:
+				current.order.push_back(i);
+				break;
+			case Phase::Liquid:
+				switch(parameters.liquid_solution) {
+				case ParametersNS::LiquidSolution::No:
+					ind.push_back(i);
+					break;
+				case ParametersNS::LiquidSolution::One:
+					liq.push_back(i);
+					break;
+				}
+				break;
+			case Phase::Solid:
+				ind.push_back(i);
+				break;
+			}
+		}
+		current.gases = current.order.size();
+		current.liquids = liq.size();
+		current.individuals = ind.size();
+		auto back_ins = std::back_inserter(current.order);
+		std::copy(liq.cbegin(), liq.cend(), back_ins);
+		std::copy(ind.cbegin(), ind.cend(), back_ins);
+		if(orderings.empty() || orderings.back().order != current.order) {
+			current.a.resize(M * N);
+			for(size_t j = 0; j != M; ++j) {
+				std::transform(current.order.cbegin(), current.order.cend(),
+							   std::next(current.a.begin(), static_cast<std::ptrdiff_t>(j * N)),
+							   [this, offset = j * N](const int i){
+					return element_matrix[offset + i]; });
+			}
+			orderings.push_back(std::move(current));
+		}
+		auto&& interval = intervals.at(k);
+		interval.ordering = orderings.size() - 1;
+		const auto& order = orderings.back().order;
+		interval.coefs.resize(N);
+		std::transform(order.cbegin(), order.cend(), interval.coefs.begin(),
+					   [this, T](const int i){
+			return &Thermodynamics::FindCoef(T, *substance_coefs[i]); });
+		interval.block.Resize(N);
+		for(size_t i = 0; i != N; ++i) {
+			interval.block.Set(i, *interval.coefs[i]);
+		}
+	}
+}
+
+const TemperatureInterval& ProblemContext::FindInterval(const double temperature_K) const
+{
+	auto it = std::upper_bound(breakpoints.cbegin(), breakpoints.cend(), temperature_K);
+	return intervals[static_cast<size_t>(std::distance(breakpoints.cbegin(), it))];
+}
+
+const TemperatureInterval& ProblemContext::FindInterval(
+		const double temperature_K, const TemperatureInterval* hint) const
+{
+	// interval k is [breakpoints[k - 1], breakpoints[k])
+	const auto is_found = [this, temperature_K](const size_t k){
+		return k < intervals.size() &&
+				(k == 0 || breakpoints[k - 1] <= temperature_K) &&
+				(k == breakpoints.size() || temperature_K < breakpoints[k]); };
+	if(hint) {
+		const auto k = static_cast<size_t>(hint - intervals.data());
+		for(auto i : {k, k + 1, k - 1}) {
+			if(is_found(i)) {
+				return intervals[i];
+			}
+		}
+	}
+	return FindInterval(temperature_K);
+}
+
+Segment ProblemContext::FindSegment(const double temperature_K) const
+{
+	auto&& interval = FindInterval(temperature_K);
+	size_t first = static_cast<size_t>(&interval - intervals.data());
+	size_t last = first;
+	if(parameters.extrapolation == ParametersNS::Extrapolation::Enable) {
+		while(first > 0 && intervals[first - 1].ordering == interval.ordering) {
+			--first;
+		}
+		while(last + 1 < intervals.size() &&
+			  intervals[last + 1].ordering == interval.ordering) {
+			++last;
+		}
+	}
+	// interval k is [breakpoints[k - 1], breakpoints[k])
+	return Segment{&intervals[first], &intervals[last],
+				first == 0 ? EnthalpyCurve::T_min : breakpoints[first - 1],
+				last == breakpoints.size() ? EnthalpyCurve::T_max : breakpoints[last]};
+}
+
+const TemperatureEntry& ProblemContext::AtTemperature(const double temperature_K) const
+{
+	auto it = std::lower_bound(initial_temperatures.cbegin(),
+							   initial_temperatures.cend(), temperature_K);
+	if(it == initial_temperatures.cend() || *it != temperature_K) {
+		throw std::logic_error("temperature is not initial");
+	}
+	auto entry = &entries[static_cast<size_t>(
+			std::distance(initial_temperatures.cbegin(), it))];
+	std::call_once(entry->flag, [this, entry, temperature_K](){
+		entry->interval = &FindInterval(temperature_K);
+		entry->properties.Resize(substance_ids.size());
+		kernels->interval(temperature_K, *this, *entry->interval,
+						  orderings[entry->interval->ordering], entry->properties);
+		entry->substances.reserve(substance_ids.size());
+		for(const auto coefs : substance_coefs) {
+			entry->substances.push_back(kernels->substance(temperature_K, *coefs));
+		}
+	});
+	return *entry;
+}
+
+size_t ProblemContext::IndexOf(const int substance_id) const
+{
+	auto it = std::lower_bound(substance_ids.cbegin(), substance_ids.cend(),
+							   substance_id);
+	assert(it != substance_ids.cend() && *it == substance_id);
+	return static_cast<size_t>(std::distance(substance_ids.cbegin(), it));
+}
+
+void Surrogate::Make(const ProblemContext& context, const double T_min_,
+					 const double T_max_, const int accuracy)
+{
+	substances = context.substance_ids.size();
+	T_max = T_max_;
+	// the functions are smooth between the breakpoints, T_min of the ranges
+	// (the integrals of HSC change there) and T0
+	std::vector<double> knots{T_min_, T_max_, Thermodynamics::T0};
+	std::copy(context.breakpoints.cbegin(), context.breakpoints.cend(),
+			  std::back_inserter(knots));
+	for(const auto& coefs : context.substance_coefs) {
+		for(const auto& coef : *coefs) {
+			knots.push_back(coef.T_min);
+		}
+	}
+	knots.erase(std::remove_if(knots.begin(), knots.end(),
+							   [T_min_, T_max_](const double T){
+		return T < T_min_ || T > T_max_; }), knots.end());
+	std::sort(knots.begin(), knots.end());
+	knots.erase(std::unique(knots.begin(), knots.end()), knots.end());
+	const double tolerance = std::pow(10.0, -accuracy);
+	for(size_t i = 1; i < knots.size(); ++i) {
+		Fit(context, knots[i - 1], knots[i], tolerance, 0);
+	}
+	starts.reserve(pieces.size());
+	std::transform(pieces.cbegin(), pieces.cend(), std::back_inserter(starts),
+				   [](const Piece& piece){ return piece.T_min; });
+	LOG("surrogate pieces:", pieces.size(), "exact:",
+		std::count_if(pieces.cbegin(), pieces.cend(),
+					  [](const Piece& piece){ return piece.exact; }))
+}
+
+void Surrogate::Fit(const ProblemContext& context, const double T_min_,
+					const double T_max_, const double tolerance,
+					const size_t depth)
+{
+	constexpr size_t max_depth = 12;
+	constexpr double min_width = 1e-3; // K
+	constexpr size_t P = degree + 1;
+	const size_t N = substances;
+	auto&& kernels = *context.kernels;
+	auto&& interval = context.FindInterval((T_min_ + T_max_) / 2);
+	auto&& ordering = context.orderings[interval.ordering];
+	const std::array<std::vector<double> Thermodynamics::PropertiesBlock::*, 3>
+			functions{kernels.c, &Thermodynamics::PropertiesBlock::H_kJ,
+					  &Thermodynamics::PropertiesBlock::Cp_J};
+	const auto T = [T_min_, T_max_](const double t){
+		return (T_min_ + T_max_) / 2 + (T_max_ - T_min_) / 2 * t; };
+	const auto bisect = [&](){
+		const double T_mid = (T_min_ + T_max_) / 2;
+		if(depth < max_depth && T_max_ - T_min_ > min_width) {
+			Fit(context, T_min_, T_mid, tolerance, depth + 1);
+			Fit(context, T_mid, T_max_, tolerance, depth + 1);
+		} else {
+			pieces.push_back(Piece{T_min_, T_max_, true, 0});
+		}
+	};
+
+	// power coefficients of the Chebyshev polynomials, T_m = sum basis[m][i] t^i,
+	// and T_m at the nodes, cos(m * theta_j), they are the same for all pieces
+	static constexpr auto basis = [](){
+		std::array<std::array<double, P>, P> basis{};
+		basis[0][0] = 1;
+		basis[1][1] = 1;
+		for(size_t m = 2; m != P; ++m) {
+			for(size_t i = 0; i != P; ++i) {
+				basis[m][i] = (i > 0 ? 2 * basis[m - 1][i - 1] : 0) - basis[m - 2][i];
+			}
+		}
+		return basis;
+	}();
+	static const auto cosines = [](){
+		std::array<std::array<double, P>, P> cosines;
+		for(size_t m = 0; m != P; ++m) {
+			for(size_t j = 0; j != P; ++j) {
+				cosines[m][j] = std::cos(m * std::numbers::pi * (j + 0.5) / P);
+			}
+		}
+		return cosines;
+	}();
+
+	// values at the Chebyshev nodes, [function][node][substance]
+	Thermodynamics::PropertiesBlock properties;
+	properties.Resize(N);
+	std::vector<double> values(functions.size() * P * N);
+	for(size_t j = 0; j != P; ++j) {
+		kernels.interval(T(cosines[1][j]), context, interval, ordering,
+						 properties);
+		for(size_t f = 0; f != functions.size(); ++f) {
+			auto&& from = properties.*functions[f];
+			if(!std::all_of(from.cbegin(), from.cend(),
+							[](const double v){ return IsFinite(v); })) {
+				bisect();
+				return;
+			}
+			std::copy(from.cbegin(), from.cend(),
+					  values.begin() + static_cast<std::ptrdiff_t>((f * P + j) * N));
+		}
+	}
+	// F = (H_ref - G) / T, H_ref is constant in the piece
+	std::vector<double> references(N);
+	for(size_t k = 0; k != N; ++k) {
+		references[k] = properties.G_kJ[k] + T(cosines[1][P - 1]) *
+						properties.F_J[k] * 1.0E-03;
+	}
+
+	const auto offset = coefficients.size();
+	coefficients.resize(offset + values.size() + N, 0.0);
+	std::vector<double> scale(functions.size() * N, 0.0);
+	for(size_t f = 0; f != functions.size(); ++f) {
+		for(size_t k = 0; k != N; ++k) {
+			for(size_t m = 0; m != P; ++m) {
+				double a = 0;
+				for(size_t j = 0; j != P; ++j) {
+					const double v = values[(f * P + j) * N + k];
+					a += v * cosines[m][j];
+					scale[f * N + k] = std::max(scale[f * N + k], std::abs(v));
+				}
+				a *= (m == 0 ? 1.0 : 2.0) / P;
+				for(size_t i = 0; i <= m; ++i) {
+					coefficients[offset + (f * P + i) * N + k] += a * basis[m][i];
+				}
+			}
+		}
+	}
+	std::copy(references.cbegin(), references.cend(),
+			  coefficients.begin() + static_cast<std::ptrdiff_t>(offset + values.size()));
+
+	// compare with the exact functions at the ends and between the nodes
+	pieces.push_back(Piece{T_min_, T_max_, false, offset});
+	Thermodynamics::PropertiesBlock approximation;
+	approximation.Resize(N);
+	for(size_t j = 0; j <= P; ++j) {
+		const double t = std::cos(std::numbers::pi * j / P);
+		const double temperature_K = T(t);
+		kernels.interval(temperature_K, context, interval, ordering, properties);
+		Evaluate(pieces.back(), t, kernels.c, approximation);
+		for(size_t f = 0; f != functions.size(); ++f) {
+			auto&& exact = properties.*functions[f];
+			auto&& approx = approximation.*functions[f];
+			for(size_t k = 0; k != N; ++k) {
+				if(!(std::abs(exact[k] - approx[k]) <= tolerance * scale[f * N + k])) {
+					pieces.pop_back();
+					coefficients.resize(offset);
+					bisect();
+					return;
+				}
+			}
+		}
+	}
+}
+
+bool Surrogate::Evaluate(const double temperature_K,
+						 std::vector<double> Thermodynamics::PropertiesBlock::* c,
+						 Thermodynamics::PropertiesBlock& properties) const
+{
+	if(starts.empty() || temperature_K < starts.front() || temperature_K > T_max) {
+		return false;
+	}
+	auto it = std::upper_bound(starts.cbegin(), starts.cend(), temperature_K);
+	auto&& piece = pieces[static_cast<size_t>(std::distance(starts.cbegin(), it)) - 1];
+	if(piece.exact) {
+		return false;
+	}
+	const double t = (2 * temperature_K - piece.T_min - piece.T_max) /
+					 (piece.T_max - piece.T_min);
+	Evaluate(piece, t, c, properties);
+	return true;
+}
+
+void Surrogate::Evaluate(const Piece& piece, const double t,
+						 std::vector<double> Thermodynamics::PropertiesBlock::* c,
+						 Thermodynamics::PropertiesBlock& properties) const
+{
+	// Horner's method for all substances at once
+	const size_t N = substances;
+	const double* coef = coefficients.data() + piece.offset;
+	for(auto function : {c, &Thermodynamics::PropertiesBlock::H_kJ,
+		 &Thermodynamics::PropertiesBlock::Cp_J}) {
+		double* result = (properties.*function).data();
+		const double* a = coef + degree * N;
+		std::copy(a, a + N, result);
+		for(size_t i = degree; i-- > 0;) {
+			a = coef + i * N;
+			for(size_t k = 0; k != N; ++k) {
+				result[k] = result[k] * t + a[k];
+			}
+		}
+		coef += (degree + 1) * N;
+	}
+	// the other functions by G = H - T * S, c = G / RT and F = (H_ref - G) / T
+	assert(c == &Thermodynamics::PropertiesBlock::c ||
+		   c == &Thermodynamics::PropertiesBlock::S_J);
+	const double T = (piece.T_min + piece.T_max + (piece.T_max - piece.T_min) * t) / 2;
+	const double RT = Thermodynamics::R * T;
+	auto&& G = properties.G_kJ;
+	auto&& H = properties.H_kJ;
+	auto&& S = properties.S_J;
+	for(size_t k = 0; k != N; ++k) {
+		if(c == &Thermodynamics::PropertiesBlock::c) {
+			G[k] = properties.c[k] * RT * 1.0E-03;
+			S[k] = (H[k] - G[k]) * 1.0E+03 / T;
+		} else {
+			G[k] = H[k] - T * S[k] * 1.0E-03;
+			properties.c[k] = G[k] * 1.0E+03 / RT;
+		}
+		properties.F_J[k] = (coef[k] - G[k]) * 1.0E+03 / T;
+	}
+}
+
+auto OptimizationItemsMaker::MakeGroupScales()
 {
-	sum = SumCompositionMolAndGram(amounts);
 	std::vector<double> composition;
 	if(sum.group_2_mol > 0.0) {
 		composition = MakeCompositionVector();
@@ -130,12 +978,12 @@ auto OptimizationItemsMaker::MakeNewAmounts(const Composition& amounts,
 		LOG("Variable composition is empty, calculate only 1 element")
 		composition.push_back(0.0);
 	}
-	std::vector<Composition> new_amounts(composition.size());
-	std::transform(composition.cbegin(), composition.cend(), new_amounts.begin(),
-				   [&](auto&& val){return MakeNewAmount(amounts, weights, val);});
-	assert(new_amounts.size() == composition.size());
-	assert(new_amounts.size() > 0);
-	return std::make_pair(composition, new_amounts);
+	std::vector<GroupScales> scales(composition.size());
+	std::transform(composition.cbegin(), composition.cend(), scales.begin(),
+				   [this](auto&& val){return MakeGroupScale(val);});
+	assert(scales.size() == composition.size());
+	assert(scales.size() > 0);
+	return std::make_pair(composition, scales);
 }
 
 OptimizationItemsMaker::OptimizationItemsMaker(
@@ -146,12 +994,21 @@ OptimizationItemsMaker::OptimizationItemsMaker(
 		const SubstanceWeights& weights,
 		const Composition& amounts)
 	: parameters{parameters_}
-	, number_of_substances{static_cast<size_t>(weights.size())}
+	, context{std::make_shared<const ProblemContext>(
+			  parameters_, elements, temp_ranges, subs_element_composition,
+			  weights, amounts)}
+	, number_of_substances{context->substance_ids.size()} // without the pruned
+	, sum{SumCompositionMolAndGram(amounts)}
 {
 	LOG(i = ++i_maker)
-	assert(number_of_substances == subs_element_composition.size());
-	assert(number_of_substances == amounts.size());
-	assert(number_of_substances == temp_ranges.size());
+	assert(static_cast<size_t>(weights.size()) == subs_element_composition.size());
+	assert(static_cast<size_t>(weights.size()) == amounts.size());
+	assert(static_cast<size_t>(weights.size()) == temp_ranges.size());
+	assert(number_of_substances == context->subs_element_composition.size());
+	assert(number_of_substances == context->amounts.size());
+	assert(number_of_substances == context->temp_ranges.size());
+	assert(number_of_substances + static_cast<size_t>(context->pruned.size()) ==
+		   static_cast<size_t>(weights.size()));
 
 	switch(parameters.workmode) {
 	case ParametersNS::Workmode::SinglePoint: {
@@ -160,58 +1017,72 @@ OptimizationItemsMaker::OptimizationItemsMaker(
 													parameters.temperature_initial_unit);
 		x_size = 1;
 		y_size = 1;
-		items.emplace_back(parameters, elements, temp_ranges,
-						   subs_element_composition, weights, amounts,
-						   temperature);
+		items.emplace_back(context, temperature);
 	}
 		break;
 	case ParametersNS::Workmode::TemperatureRange: {
-		auto temperatures = MakeTemperatureVector();
+		auto temperatures = InitialTemperatures(parameters);
 		x_size = temperatures.size();
 		y_size = 1;
 		items.reserve(x_size);
 		for(const auto& temperature : temperatures) {
-			items.emplace_back(parameters, elements,
-							   temp_ranges, subs_element_composition,
-							   weights, amounts, temperature);
+			items.emplace_back(context, temperature);
 		}
 	}
 		break;
 	case ParametersNS::Workmode::CompositionRange: {
 		auto temperature = Thermodynamics::ToKelvin(parameters.temperature_initial,
 													parameters.temperature_initial_unit);
-		auto [composition, new_amounts] = MakeNewAmounts(amounts, weights);
-		x_size = new_amounts.size();
+		auto [composition, scales] = MakeGroupScales();
+		x_size = scales.size();
 		y_size = 1;
 		items.reserve(x_size);
 		// std::transform makes copy, emplace_back doesn't
-		size_t i = 0;
-		for(const auto& new_amount : new_amounts) {
-			items.emplace_back(parameters, elements,
-							   temp_ranges, subs_element_composition,
-							   weights, new_amount, temperature,
-							   composition.at(i++));
+		for(size_t i = 0; i != scales.size(); ++i) {
+			items.emplace_back(context, temperature,
+							   composition.at(i), scales.at(i));
 		}
 	}
 		break;
 	case ParametersNS::Workmode::TemperatureCompositionRange: {
-		auto temperatures = MakeTemperatureVector();
-		auto [composition, new_amounts] = MakeNewAmounts(amounts, weights);
+		auto temperatures = InitialTemperatures(parameters);
+		auto [composition, scales] = MakeGroupScales();
 		x_size = temperatures.size();
-		y_size = new_amounts.size();
+		y_size = scales.size();
 		items.reserve(x_size * y_size);
 		for(const auto& temperature : temperatures) {
-			size_t i = 0;
-			for(const auto& new_amount : new_amounts) {
-				items.emplace_back(parameters, elements,
-								   temp_ranges, subs_element_composition,
-								   weights, new_amount, temperature,
-								   composition.at(i++));
+			for(size_t i = 0; i != scales.size(); ++i) {
+				items.emplace_back(context, temperature,
+								   composition.at(i), scales.at(i));
 			}
 		}
 	}
 		break;
 	}
+
+	switch(parameters.continuation) {
+	case ParametersNS::Continuation::Disable:
+		break;
+	case ParametersNS::Continuation::Enable:
+		switch(parameters.workmode) {
+		case ParametersNS::Workmode::SinglePoint:
+			break;
+		case ParametersNS::Workmode::TemperatureRange:
+		case ParametersNS::Workmode::CompositionRange:
+			MakeChains(1, items.size());
+			break;
+		case ParametersNS::Workmode::TemperatureCompositionRange:
+			// along the composition axis, one row for each temperature
+			MakeChains(x_size, y_size);
+			break;
+		}
+		break;
+	}
+
+	if(parameters.target == ParametersNS::Target::AdiabaticTemperature &&
+			parameters.adiabatic_solver == ParametersNS::AdiabaticSolver::EnthalpyCurve) {
+		MakeEnthalpyCurves();
+	}
 }
 
 #ifndef NDEBUG
@@ -221,17 +1092,6 @@ OptimizationItemsMaker::~OptimizationItemsMaker()
 }
 #endif
 
-std::vector<double> OptimizationItemsMaker::MakeTemperatureVector()
-{
-	std::vector<double> temperature;
-	Thermodynamics::RangeTabulator(parameters.temperature_range, temperature);
-	std::transform(temperature.cbegin(), temperature.cend(),
-				   temperature.begin(),
-				   [tu = parameters.temperature_range_unit](double t){
-		return Thermodynamics::ToKelvin(t, tu); });
-	return temperature;
-}
-
 std::vector<double> OptimizationItemsMaker::MakeCompositionVector()
 {
 	std::vector<double> composition;
@@ -239,42 +1099,209 @@ std::vector<double> OptimizationItemsMaker::MakeCompositionVector()
 	return composition;
 }
 
+void OptimizationItemsMaker::MakeChains(const size_t rows,
+										const size_t row_size)
+{
+	// Rows are split into segments to keep all threads busy,
+	// the first item of each segment starts from scratch.
+	const size_t threads = static_cast<size_t>(std::max(parameters.threads, 1));
+	const size_t segments = std::clamp((threads + rows - 1) / rows,
+									   size_t{1}, std::max(row_size, size_t{1}));
+	const size_t segment_size = (row_size + segments - 1) / segments;
+	chains.clear();
+	chains.reserve(rows * segments);
+	for(size_t row = 0; row != rows; ++row) {
+		for(size_t first = 0; first < row_size; first += segment_size) {
+			chains.push_back(Chain{row * row_size + first,
+								   std::min(segment_size, row_size - first)});
+		}
+	}
+}
+
+void EnthalpyCurve::Calculate(const std::function<double(const double)>& H)
+{
+	std::call_once(flag, [this, &H](){ Make(H); });
+}
+
+void EnthalpyCurve::Make(const std::function<double(const double)>& H)
+{
+	constexpr int initial_intervals = 32;
+	std::vector<std::pair<double, double>> nodes;
+	nodes.reserve(initial_intervals * 4);
+	for(int i = 0; i <= initial_intervals; ++i) {
+		auto T = T_min + (T_max - T_min) * i / initial_intervals;
+		nodes.emplace_back(T, H(T));
+	}
+	for(int i = 0; i != initial_intervals; ++i) {
+		auto [T_lo, H_lo] = nodes.at(i);
+		auto [T_hi, H_hi] = nodes.at(i + 1);
+		Refine(H, T_lo, H_lo, T_hi, H_hi, nodes);
+	}
+	std::sort(nodes.begin(), nodes.end());
+	temperatures.resize(nodes.size());
+	enthalpies.resize(nodes.size());
+	std::transform(nodes.cbegin(), nodes.cend(), temperatures.begin(),
+				   [](const auto& node){ return node.first; });
+	std::transform(nodes.cbegin(), nodes.cend(), enthalpies.begin(),
+				   [](const auto& node){ return node.second; });
+	MakeSlopes();
+}
+
+void EnthalpyCurve::Refine(const std::function<double(const double)>& H,
+						   const double T_lo, const double H_lo,
+						   const double T_hi, const double H_hi,
+						   std::vector<std::pair<double, double>>& nodes)
+{
+	// The interval is halved until the linear interpolation error
+	// at its middle is less than mesh_accuracy in temperature terms.
+	// The interval which is still inaccurate at min_step contains
+	// a phase transition, the interpolated slope is meaningless there.
+	constexpr double mesh_accuracy = 1; // K
+	constexpr double min_step = 1; // K
+	auto T_mid = (T_lo + T_hi) / 2;
+	auto H_mid = H(T_mid);
+	nodes.emplace_back(T_mid, H_mid);
+	auto slope = (H_hi - H_lo) / (T_hi - T_lo);
+	if(std::abs(H_mid - (H_lo + H_hi) / 2) <= mesh_accuracy * std::abs(slope)) {
+		return;
+	}
+	if(T_mid - T_lo < 2 * min_step) {
+		transitions.emplace_back(T_lo, T_hi);
+		return;
+	}
+	Refine(H, T_lo, H_lo, T_mid, H_mid, nodes);
+	Refine(H, T_mid, H_mid, T_hi, H_hi, nodes);
+}
+
+void EnthalpyCurve::MakeSlopes()
+{
+	// Fritsch-Butland slopes, the interpolation is monotone on each interval
+	// where the nodes are monotone
+	auto size = temperatures.size();
+	slopes.assign(size, 0.0);
+	if(size < 2) return;
+	auto secant = [this](const size_t k){
+		return (enthalpies.at(k + 1) - enthalpies.at(k)) /
+				(temperatures.at(k + 1) - temperatures.at(k));
+	};
+	slopes.front() = secant(0);
+	slopes.back() = secant(size - 2);
+	for(size_t k = 1; k < size - 1; ++k) {
+		auto d0 = secant(k - 1);
+		auto d1 = secant(k);
+		if(d0 * d1 <= 0) continue;
+		auto h0 = temperatures.at(k) - temperatures.at(k - 1);
+		auto h1 = temperatures.at(k + 1) - temperatures.at(k);
+		auto w0 = 2 * h1 + h0;
+		auto w1 = h1 + 2 * h0;
+		slopes.at(k) = (w0 + w1) / (w0 / d0 + w1 / d1);
+	}
+}
+
+EnthalpyCurve::Root EnthalpyCurve::FindRoot(const double H) const
+{
+	if(temperatures.empty() || H < enthalpies.front()) {
+		return Root{T_min, T_min, T_min};
+	}
+	auto it = std::adjacent_find(enthalpies.cbegin(), enthalpies.cend(),
+								 [H](const double H_lo, const double H_hi){
+		return H_lo <= H && H < H_hi; });
+	if(it == enthalpies.cend()) {
+		return Root{T_max, T_max, T_max};
+	}
+	auto k = static_cast<size_t>(std::distance(enthalpies.cbegin(), it));
+	double t_lo = 0, t_hi = 1;
+	for(int i = 0; i != 50; ++i) {
+		auto t = (t_lo + t_hi) / 2;
+		if(Hermite(k, t) < H) {
+			t_lo = t;
+		} else {
+			t_hi = t;
+		}
+	}
+	auto T_lo = temperatures.at(k);
+	auto T_hi = temperatures.at(k + 1);
+	return Root{T_lo, T_hi, T_lo + (T_hi - T_lo) * (t_lo + t_hi) / 2};
+}
+
+double EnthalpyCurve::Slope(const double T) const
+{
+	if(temperatures.size() < 2) return 0.0;
+	if(std::any_of(transitions.cbegin(), transitions.cend(),
+				   [T](const auto& transition){
+				   return transition.first <= T && T <= transition.second; })) {
+		return 0.0;
+	}
+	auto it = std::upper_bound(temperatures.cbegin(), std::prev(temperatures.cend()), T);
+	auto k = static_cast<size_t>(std::distance(temperatures.cbegin(), it));
+	k = std::clamp(k, size_t{1}, temperatures.size() - 1) - 1;
+	auto h = temperatures.at(k + 1) - temperatures.at(k);
+	auto t = std::clamp((T - temperatures.at(k)) / h, 0.0, 1.0);
+	auto t2 = t * t;
+	return ((6*t2 - 6*t) * enthalpies.at(k) + (-6*t2 + 6*t) * enthalpies.at(k + 1)) / h +
+			(3*t2 - 4*t + 1) * slopes.at(k) + (3*t2 - 2*t) * slopes.at(k + 1);
+}
+
+double EnthalpyCurve::Hermite(const size_t k, const double t) const
+{
+	auto h = temperatures.at(k + 1) - temperatures.at(k);
+	auto t2 = t * t;
+	auto t3 = t2 * t;
+	return (2*t3 - 3*t2 + 1) * enthalpies.at(k) + (t3 - 2*t2 + t) * slopes.at(k) * h +
+			(-2*t3 + 3*t2) * enthalpies.at(k + 1) + (t3 - t2) * slopes.at(k + 1) * h;
+}
+
+void OptimizationItemsMaker::MakeEnthalpyCurves()
+{
+	switch(parameters.workmode) {
+	case ParametersNS::Workmode::SinglePoint:
+	case ParametersNS::Workmode::CompositionRange:
+		// each item has its own composition, nothing to share
+		break;
+	case ParametersNS::Workmode::TemperatureRange:
+	case ParametersNS::Workmode::TemperatureCompositionRange: {
+		// one curve for each composition, i.e. for each of y_size columns
+		std::vector<std::shared_ptr<EnthalpyCurve>> curves(y_size);
+		std::generate(curves.begin(), curves.end(),
+					  [](){ return std::make_shared<EnthalpyCurve>(); });
+		for(size_t i = 0; i != items.size(); ++i) {
+			items.at(i).enthalpy_curve = curves.at(i % curves.size());
+		}
+	}
+		break;
+	}
+}
+
+void CalculateChain(OptimizationVector& items, const Chain& chain)
+{
+	assert(chain.first + chain.size <= items.size());
+	if(chain.size == 0) return;
+	auto first = std::next(items.begin(), static_cast<std::ptrdiff_t>(chain.first));
+	auto last = std::next(first, static_cast<std::ptrdiff_t>(chain.size));
+	first->Calculate();
+	for(auto previous = first++; first != last; previous = first++) {
+		first->Calculate(*previous);
+	}
+}
+
 OptimizationItem::OptimizationItem(
-		const ParametersNS::Parameters& parameters_,
-		const std::vector<int>& elements_,
-		const SubstancesTempRangeData& temp_ranges_,
-		const SubstancesElementComposition& subs_element_composition_,
-		const SubstanceWeights& weights_,
-		const Composition& amounts_,
+		const std::shared_ptr<const ProblemContext>& context_,
 		const double initial_temperature_K,
-		const double variable_composition)
-	: parameters{parameters_}
-	, elements{elements_}
-	, temp_ranges{temp_ranges_}
-	, subs_element_composition{subs_element_composition_}
-	, weights{weights_}
-	, amounts{amounts_}
+		const double variable_composition,
+		const GroupScales& scales_)
+	: context{context_}
+	, scales{scales_}
 	, temperature_K_initial{initial_temperature_K}
 	, temperature_K_current{initial_temperature_K}
 	, composition_variable{variable_composition}
 {
 	LOG(i = ++i_items)
-	number.elements = elements.size();
-	number.substances = weights.size();
-	substances_id_order.resize(number.substances);
-	n.resize(number.substances);
-	c.resize(number.substances);
-	ub.resize(number.substances);
-	constraints.resize(number.elements);
-	for(auto&& constraint : constraints) {
-		constraint.a_j.resize(number.substances);
-	}
-	// Do not resize anything later
-
-	// TODO change initial data in this class for shared_ptr
+	number.elements = context->elements.size();
+	number.substances = context->weights.size();
+	// Buffers are allocated in AcquireBuffers()
 
 	// Order of substances changes every time when current temperature changes
-	// then changes order in A matrix, i.e. needs to remake constraints vector.
+	// then changes order in A matrix, it is taken from the current ordering.
 
 	// When extrapolation is disabled, the maximum value for the substance
 	// that does not exist at the current temperature is zero.
@@ -291,10 +1318,12 @@ OptimizationItem::~OptimizationItem()
 void OptimizationItem::Calculate()
 {
 	LOGV()
+	AcquireBuffers();
+	sum_of_initial = SumOfInitial();
 	MakeConstraintsB(); // vector B depends on amounts
 	H_kJ_Initial();
 
-	switch(parameters.target) {
+	switch(context->parameters.target) {
 	case ParametersNS::Target::Equilibrium:
 		Equilibrium(temperature_K_initial);
 		H_current = H_kJ_Current();
@@ -303,352 +1332,2797 @@ void OptimizationItem::Calculate()
 		AdiabaticTemperature();
 		break;
 	}
-
-	MakeAmountsOfEquilibrium();
-	sum_of_initial = GetSumAndRecalculate(amounts);
+
+	MakeAmountsOfEquilibrium();
+	ReleaseBuffers();
+}
+
+void OptimizationItem::Calculate(const OptimizationItem& previous)
+{
+	start_point = &previous.amounts_of_equilibrium;
+	Calculate();
+	start_point = nullptr;
+}
+
+// Buffers of the solver are needed only during the calculation of an item,
+// they are recycled between the items calculated by the same thread.
+struct Buffers
+{
+	std::vector<double> n, c, ub;
+	std::vector<double> b;
+	Thermodynamics::PropertiesBlock properties;
+};
+static thread_local Buffers spare_buffers;
+
+void OptimizationItem::AcquireBuffers()
+{
+	std::swap(n, spare_buffers.n);
+	std::swap(c, spare_buffers.c);
+	std::swap(properties, spare_buffers.properties);
+	std::swap(ub, spare_buffers.ub);
+	std::swap(b, spare_buffers.b);
+	n.resize(number.substances);
+	c.resize(number.substances);
+	properties.Resize(number.substances);
+	ub.resize(number.substances);
+	b.resize(number.elements);
+	// Do not resize anything later
+	interval = nullptr;
+	ordering = nullptr;
+	current_properties = nullptr;
+}
+
+void OptimizationItem::ReleaseBuffers()
+{
+	std::swap(n, spare_buffers.n);
+	std::swap(c, spare_buffers.c);
+	std::swap(properties, spare_buffers.properties);
+	std::swap(ub, spare_buffers.ub);
+	std::swap(b, spare_buffers.b);
+}
+
+Amounts OptimizationItem::ScaledAmount(const int id) const
+{
+	auto amount = context->amounts.at(id);
+	if(scales.group_1 != 1.0 || scales.group_2 != 1.0) {
+		amount.group_1_mol *= scales.group_1;
+		amount.group_1_gram *= scales.group_1;
+		amount.group_2_mol *= scales.group_2;
+		amount.group_2_gram *= scales.group_2;
+		amount.sum_mol = amount.group_1_mol + amount.group_2_mol;
+		amount.sum_gram = amount.group_1_gram + amount.group_2_gram;
+	}
+	return amount;
+}
+
+Amounts OptimizationItem::InitialAmount(const int id) const
+{
+	// sum_of_initial is known after the calculation
+	auto amount = ScaledAmount(id);
+	amount.sum_atpct = sum_of_initial.sum_mol > 0.0 ?
+				(100 * amount.sum_mol / sum_of_initial.sum_mol) : 0.0;
+	amount.sum_wtpct = sum_of_initial.sum_gram > 0.0 ?
+				(100 * amount.sum_gram / sum_of_initial.sum_gram) : 0.0;
+	return amount;
+}
+
+Amounts OptimizationItem::SumOfInitial() const
+{
+	Composition amounts;
+	for(const auto& [id, _] : context->amounts) {
+		amounts[id] = ScaledAmount(id);
+	}
+	return GetSumAndRecalculate(amounts);
+}
+
+void OptimizationItem::DefineOrderOfSubstances()
+{
+	// the solvers of the adiabatic temperature and the ranges
+	// move the temperature by small steps
+	if(temperature_K_current == temperature_K_initial) {
+		interval = context->AtTemperature(temperature_K_current).interval;
+	} else {
+		interval = &context->FindInterval(temperature_K_current, interval);
+	}
+	ordering = &context->orderings[interval->ordering];
+	number.gases = ordering->gases;
+	number.liquids = ordering->liquids;
+	number.individuals = ordering->individuals;
+	assert(number.gases + number.liquids + number.individuals ==
+		   number.substances);
+}
+
+void OptimizationItem::MakeConstraintsB()
+{
+	const auto N = number.substances;
+	std::vector<double> mol(N);
+	std::transform(context->substance_ids.cbegin(), context->substance_ids.cend(),
+				   mol.begin(), [this](const int id){
+		return ScaledAmount(id).sum_mol; });
+	for(size_t j = 0; j != number.elements; ++j) {
+		auto a_j = std::next(context->element_matrix.cbegin(),
+							 static_cast<std::ptrdiff_t>(j * N));
+		b.at(j) = std::transform_reduce(mol.cbegin(), mol.cend(),
+													  a_j, double{0.0});
+	}
+}
+
+void OptimizationItem::MakeC()
+{
+	// depends on the order of substances,
+	// H and Cp of the current temperature are kept for H_kJ_Current
+	// and Cp_kJ_Current
+	auto&& kernels = *context->kernels;
+	if(temperature_K_current == temperature_K_initial) {
+		// e.g. the target is the equilibrium, the entry is read in place
+		auto&& entry = context->AtTemperature(temperature_K_current);
+		assert(entry.interval == interval);
+		current_properties = &entry.properties;
+	} else {
+		if(!context->surrogate.Evaluate(temperature_K_current, kernels.c,
+										properties)) {
+			kernels.interval(temperature_K_current, *context, *interval,
+							 *ordering, properties);
+		}
+		current_properties = &properties;
+	}
+	auto&& from = current_properties->*kernels.c;
+	std::copy(from.cbegin(), from.cend(), c.begin());
+}
+
+void OptimizationItem::MakeUB()
+{
+	// depends on constraints
+	std::fill(ub.begin(), ub.end(), std::numeric_limits<double>::max());
+	for(size_t j = 0; j != number.elements; ++j) {
+		auto a_j = ordering->a.cbegin() + static_cast<std::ptrdiff_t>(j * number.substances);
+		std::transform(a_j, a_j + static_cast<std::ptrdiff_t>(number.substances),
+					   ub.cbegin(), ub.begin(),
+					   [bj = b[j]](auto aji, auto ubi){
+			if(aji > 0) {
+				auto tmp = bj / aji;
+				return tmp < ubi ? tmp : ubi;
+			} else {
+				return ubi;
+			}
+		});
+	}
+
+	// check for extrapolation and zeroize if it not exist
+	switch(context->parameters.extrapolation) {
+	case ParametersNS::Extrapolation::Disable:
+		std::transform(ordering->order.cbegin(), ordering->order.cend(),
+					   ub.cbegin(), ub.begin(),
+					   [this](const int i, const double ubi){
+			return IsExistAtCurrentTemperature(i) ? ubi : 0.0;
+		});
+		break;
+	case ParametersNS::Extrapolation::Enable:
+		break;
+	}
+}
+
+void OptimizationItem::MakeN()
+{
+	if(start_point) {
+		// The order of substances can be changed by a phase transition,
+		// so n is remapped by substance id
+		std::transform(ordering->order.cbegin(), ordering->order.cend(),
+					   ub.cbegin(), n.begin(), [this](const int i, double ubi){
+			return std::clamp(start_point->at(context->substance_ids[i]).sum_mol,
+							  0.0, ubi);
+		});
+		return;
+	}
+	std::transform(ub.cbegin(), ub.cend(), n.begin(), [](double n){
+		return n / 2;
+	});
+	switch(context->parameters.initial_estimate) {
+	case ParametersNS::InitialEstimate::Linear:
+		MakeLinearEstimate();
+		break;
+	case ParametersNS::InitialEstimate::HalfOfUB:
+		break;
+	}
+}
+
+void OptimizationItem::Equilibrium()
+{
+	DefineOrderOfSubstances();
+	MakeUB(); // extrapolation is taken into account here
+	MakeC(); // depends on current temperature
+
+	// purely condensed, the exact vertex
+	if(MinimizeLinear()) {
+		return;
+	}
+	MakeN(); // the start point, the linear estimate or half of ub
+
+	switch(context->parameters.equilibrium_solver) {
+	case ParametersNS::EquilibriumSolver::ElementPotentials:
+		// the entropy is not a sum of chemical potentials,
+		// nlopt is the fallback
+		if(context->parameters.minimization_function ==
+				ParametersNS::MinimizationFunction::GibbsEnergy &&
+				MinimizeByElementPotentials()) {
+			return;
+		}
+		MakeN();
+		break;
+	case ParametersNS::EquilibriumSolver::Dual:
+		if(context->parameters.minimization_function ==
+				ParametersNS::MinimizationFunction::GibbsEnergy &&
+				MinimizeByDual()) {
+			return;
+		}
+		MakeN();
+		break;
+	case ParametersNS::EquilibriumSolver::ActiveSet:
+		if(MinimizeByActiveSet()) {
+			return;
+		}
+		MakeN();
+		break;
+	case ParametersNS::EquilibriumSolver::NLopt:
+		break;
+	}
+	if(context->parameters.decomposition == ParametersNS::Decomposition::Enable &&
+			context->blocks > 1) {
+		if(MinimizeByBlocks()) {
+			return;
+		}
+		MakeN();
+	}
+	MinimizeByNLopt();
+}
+
+void OptimizationItem::MinimizeByNLopt()
+{
+	nlopt::result result;
+	result_of_optimization = Minimize(nlopt::LD_SLSQP, result);
+	if(result == nlopt::XTOL_REACHED) return;
+	result_of_optimization = Minimize(nlopt::LD_AUGLAG_EQ, result);
+	if(result == nlopt::XTOL_REACHED) return;
+	result_of_optimization = Minimize(nlopt::LD_SLSQP, result);
+}
+
+void OptimizationItem::Equilibrium(const double temperature_K)
+{
+	temperature_K_current = temperature_K;
+	Equilibrium();
+}
+
+void OptimizationItem::AdiabaticTemperature()
+{
+	switch(context->parameters.adiabatic_solver) {
+	case ParametersNS::AdiabaticSolver::Bisection:
+		AdiabaticTemperatureBisection();
+		break;
+	case ParametersNS::AdiabaticSolver::Newton:
+		AdiabaticTemperatureNewton();
+		break;
+	case ParametersNS::AdiabaticSolver::EnthalpyCurve:
+		AdiabaticTemperatureEnthalpyCurve();
+		break;
+	case ParametersNS::AdiabaticSolver::Isenthalpic:
+		AdiabaticTemperatureIsenthalpic();
+		break;
+	}
+}
+
+void OptimizationItem::AdiabaticTemperatureBisection()
+{
+	double T_min = 298.15;
+	double T_max = 10000;
+	double T_cur;
+	Equilibrium(T_min);
+	H_current = H_kJ_Current();
+	if(H_initial < H_current) {
+		return;
+	}
+	Equilibrium(T_max);
+	H_current = H_kJ_Current();
+	if(H_initial > H_current) {
+		return;
+	}
+	T_cur = (T_min + T_max) / 2;
+	Equilibrium(T_cur);
+	H_current = H_kJ_Current();
+	double at_epsilon = std::pow(10, -context->parameters.at_accuracy)/2;
+#if !defined(NDEBUG) && defined(VERBOSE_DEBUG)
+	int n = 0;
+#endif
+	while((std::abs(T_max - T_min) > at_epsilon))
+	{
+		if(H_initial < H_current) {
+			T_max = T_cur;
+		} else {
+			T_min = T_cur;
+		}
+		T_cur = (T_min + T_max) / 2;
+		Equilibrium(T_cur);
+		H_current = H_kJ_Current();
+
+#if !defined(NDEBUG) && defined(VERBOSE_DEBUG)
+		qDebug() << Qt::fixed << qSetRealNumberPrecision(10) << ++n
+				 << "H_current:" << H_current << "\tT_cur" << T_cur
+				 << "\tdelta_H:" << std::abs(H_current - H_initial)
+				 << "\tdelta_T:" << std::abs(T_max - T_min);
+#endif
+	}
+}
+
+void OptimizationItem::AdiabaticTemperatureNewton()
+{
+	double f = EnthalpyResidual(EnthalpyCurve::T_min);
+	if(f > 0) {
+		return;
+	}
+	// H(T_max) is calculated only if it is necessary
+	SafeguardedNewton(EnthalpyCurve::T_min, EnthalpyCurve::T_max,
+					  EnthalpyCurve::T_min, f, false, nullptr);
+}
+
+void OptimizationItem::AdiabaticTemperatureEnthalpyCurve()
+{
+	if(!enthalpy_curve) {
+		// the composition is not shared with other items
+		AdiabaticTemperatureNewton();
+		return;
+	}
+	enthalpy_curve->Calculate([this](const double temperature_K){
+		Equilibrium(temperature_K);
+		return H_kJ_Current();
+	});
+	auto root = enthalpy_curve->FindRoot(H_initial);
+	double f = EnthalpyResidual(root.T);
+	if(root.T_lo == root.T_hi) {
+		return;
+	}
+	SafeguardedNewton(root.T_lo, root.T_hi, root.T, f, true,
+					  enthalpy_curve.get());
+}
+
+void OptimizationItem::AdiabaticTemperatureIsenthalpic()
+{
+	// The equilibrium with H = H_initial is found as one optimization
+	// in (n, T) in the segment of the estimated temperature. If the optimum
+	// is at an end of the segment, the equilibrium at the end brackets
+	// the root and the next segment is tried. If the optimization fails,
+	// Newton's method continues in the bracket.
+	double f = EnthalpyResidual(EnthalpyCurve::T_min);
+	if(f > 0) {
+		return;
+	}
+	const double at_epsilon = std::pow(10, -context->parameters.at_accuracy)/2;
+	double T_lo = EnthalpyCurve::T_min;
+	double T_hi = EnthalpyCurve::T_max;
+	double T_cur = T_lo;	// the current equilibrium, f = f(T_cur)
+	bool is_hi_known = false;
+	// the isenthalpic optimization changes T, the order and n of the item,
+	// they are of the equilibrium at T_cur only after EnthalpyResidual()
+	bool is_changed = false;
+	// the first estimate by the heat capacity of the composition at T_min
+	double T = Cp_kJ_Current() > 0 ? T_lo - f / Cp_kJ_Current() : T_hi;
+	if(!(T < T_hi)) {
+		T = (T_lo + T_hi) / 2;
+	}
+	for(size_t i = 0, size = context->intervals.size(); i != size; ++i) {
+		auto segment = context->FindSegment(T);
+		segment.T_min = std::max(segment.T_min, T_lo);
+		segment.T_max = std::min(segment.T_max, T_hi);
+		double T_new = T;
+		double residual_K = 0;
+		bool is_feasible = true;
+		// the segment can be cut by the bracket to a point
+		const bool is_point = segment.T_max - segment.T_min <= at_epsilon;
+		if(!is_point) {
+			is_changed = true;
+		}
+		if(is_point || !IsenthalpicEquilibrium(segment, T_new, residual_K, is_feasible)) {
+			if(!is_feasible && segment.T_min > T_lo) {
+				// the existing substances can not hold the elements,
+				// e.g. the ranges end below the segment
+				T_hi = segment.T_min;
+				T = (T_lo + T_hi) / 2;
+				continue;
+			}
+			if(segment.T_min <= T_lo) {
+				break;
+			}
+			// the equilibrium at the lower end shows the direction
+			T_new = segment.T_min;
+			residual_K = 0;
+		}
+		double end;
+		bool is_upper = false;
+		bool is_local = false;
+		if(segment.T_min + at_epsilon < T_new && T_new < segment.T_max - at_epsilon &&
+				std::abs(residual_K) <= at_epsilon) {
+			// n is the optimum at T_new in the order of the segment,
+			// it is checked by the minimization of G at T_new
+			temperature_K_current = T_new;
+			DefineOrderOfSubstances();
+			MakeC();
+			const OptimizationItem* self = this;
+			std::vector<double> grad;
+			const double G = context->kernels->objective(n, grad, &self);
+			const auto amounts = n;
+			f = EnthalpyResidual(T_new);
+			is_changed = false;
+			if(result_of_optimization > G - 1e-6 * std::max(1.0, std::abs(G))) {
+				n = amounts;
+				H_current = H_kJ_Current();
+				result_of_optimization = G;
+				return;
+			}
+			// a local optimum, e.g. of the extrapolated substances,
+			// the equilibrium at T_new brackets the root
+			end = T_new;
+			T_cur = end;
+			is_local = true;
+		} else {
+			is_upper = T_new - segment.T_min > segment.T_max - T_new;
+			end = is_upper ? segment.T_max : segment.T_min;
+			if(end != T_cur || is_changed) {
+				// the upper end is calculated in the next segment
+				f = EnthalpyResidual(end);
+				T_cur = end;
+				is_changed = false;
+			}
+		}
+		if(f < 0) {
+			T_lo = end;
+		} else {
+			T_hi = end;
+			is_hi_known = true;
+		}
+		if(T_hi - T_lo <= at_epsilon || (is_upper && f >= 0 && residual_K < 0)) {
+			// the root is the end or the jump of H at a phase transition
+			return;
+		}
+		if(!is_local && is_upper != (f < 0)) {
+			// the root is in the segment, but it is not found
+			SafeguardedNewton(T_lo, T_hi, T_cur, f, is_hi_known, nullptr);
+			return;
+		}
+		// Newton's step from the end or bisection if it leaves the bracket
+		const double slope = Cp_kJ_Current();
+		T = slope > 0 ? end - f / slope : T_lo;
+		if(!(T_lo < T && T < T_hi)) {
+			T = (T_lo + T_hi) / 2;
+		}
+	}
+	// n is changed by the optimization, the equilibrium is restored
+	T_cur = std::clamp(T_cur, T_lo, T_hi);
+	f = EnthalpyResidual(T_cur);
+	SafeguardedNewton(T_lo, T_hi, T_cur, f, is_hi_known, nullptr);
+}
+
+double OptimizationItem::EnthalpyResidual(const double temperature_K)
+{
+	Equilibrium(temperature_K);
+	H_current = H_kJ_Current();
+	return H_current - H_initial;
+}
+
+void OptimizationItem::SafeguardedNewton(double T_lo, double T_hi,
+										 double T_cur, double f,
+										 bool is_hi_known,
+										 const EnthalpyCurve* curve)
+{
+	// Safeguarded Newton's method (rtsafe) for H(T) = H_initial,
+	// the current equilibrium is at T_cur and H(T_lo) < H_initial.
+	// The slope of H(T) is the heat capacity of the current composition
+	// or the slope of the equilibrium curve, which includes the heat
+	// of reactions.
+	// The bisection step is used when the Newton step leaves the bracket
+	// or does not halve the residual, e.g. at the enthalpy jumps
+	// of phase transitions.
+	// A small Newton step does not prove the root, so it is continued by
+	// at_epsilon/2 to cross the root and the iterations end only when
+	// the bracket is within the accuracy.
+	const double at_epsilon = std::pow(10, -context->parameters.at_accuracy)/2;
+	if(f < 0) {
+		T_lo = T_cur;
+	} else {
+		T_hi = T_cur;
+		is_hi_known = true;
+	}
+	double dT = T_hi - T_lo;
+	double dT_old = dT;
+#if !defined(NDEBUG) && defined(VERBOSE_DEBUG)
+	int n = 0;
+#endif
+	while(T_hi - T_lo > at_epsilon)
+	{
+		double slope = curve ? curve->Slope(T_cur) : 0.0;
+		if(slope <= 0) {
+			slope = Cp_kJ_Current();
+		}
+		dT_old = dT;
+		if(slope <= 0 ||
+				((T_cur - T_hi) * slope - f) * ((T_cur - T_lo) * slope - f) > 0 ||
+				std::abs(2 * f) > std::abs(dT_old * slope)) {
+			dT = (T_hi - T_lo) / 2;
+			T_cur = T_lo + dT;
+		} else {
+			dT = f / slope;
+			if(std::abs(dT) < at_epsilon / 2) {
+				dT += std::copysign(at_epsilon / 2, dT);
+			}
+			if(T_cur - dT <= T_lo || T_cur - dT >= T_hi) {
+				dT = (T_hi - T_lo) / 2;
+				T_cur = T_lo + dT;
+			} else {
+				T_cur -= dT;
+			}
+		}
+		f = EnthalpyResidual(T_cur);
+
+#if !defined(NDEBUG) && defined(VERBOSE_DEBUG)
+		qDebug() << Qt::fixed << qSetRealNumberPrecision(10) << ++n
+				 << "H_current:" << H_current << "\tT_cur" << T_cur
+				 << "\tdelta_H:" << std::abs(f)
+				 << "\tdelta_T:" << std::abs(dT);
+#endif
+		if(f < 0) {
+			T_lo = T_cur;
+		} else {
+			T_hi = T_cur;
+			is_hi_known = true;
+		}
+	}
+	if(!is_hi_known) {
+		// H_initial is greater than H(T_max)
+		EnthalpyResidual(T_hi);
+	}
+}
+
+void OptimizationItem::H_kJ_Initial()
+{
+	auto&& substances = context->AtTemperature(temperature_K_initial).substances;
+	auto properties = [this, &substances](const int id){
+		return substances[context->IndexOf(id)];
+	};
+
+	switch(context->parameters.H_initial_by) {
+	case ParametersNS::H_Initial_By::AsChecked:
+		H_initial = std::accumulate(context->amounts.cbegin(), context->amounts.cend(),
+									double{0.0}, [this, &properties](double sum,
+									Composition::const_reference amount){
+			auto sum_mol = ScaledAmount(amount.first).sum_mol;
+			if(sum_mol > 0.0) {
+				return sum + properties(amount.first).H_kJ * sum_mol;
+			} else {
+				return sum;
+			}
+		});
+		return;
+	case ParametersNS::H_Initial_By::ByMinimumGibbsEnergy: {
+		double H_sum{0.0};
+		for(const auto& [sub_id, _] : context->amounts) {
+			auto sum_mol = ScaledAmount(sub_id).sum_mol;
+			if(sum_mol <= 0.0) continue;
+			auto p_min = properties(sub_id);
+			const auto& sub_cmp_cur = context->subs_element_composition.at(sub_id);
+			for(const auto& [sub_id_n, sub_cmp_n] :	context->subs_element_composition) {
+				if(sub_id_n == sub_id) continue;
+				if(sub_cmp_cur == sub_cmp_n) {
+					auto p = properties(sub_id_n);
+					if(p.G_kJ < p_min.G_kJ) {
+						p_min = p;
+					}
+				}
+			}
+			H_sum += p_min.H_kJ * sum_mol;
+		}
+		H_initial = H_sum;
+	}
+		return;
+	}
+	throw std::logic_error("out of range in switch");
+}
+
+double OptimizationItem::H_kJ_Current()
+{
+	// properties are made by MakeC at the current temperature
+	return std::transform_reduce(n.cbegin(), n.cend(),
+								 current_properties->H_kJ.cbegin(), double{0.0});
+}
+
+double OptimizationItem::Cp_kJ_Current()
+{
+	// properties are made by MakeC at the current temperature
+	return 1.0E-3 * std::transform_reduce(n.cbegin(), n.cend(),
+										  current_properties->Cp_J.cbegin(),
+										  double{0.0});
+}
+
+bool OptimizationItem::IsFeasible() const
+{
+	// each element of the system is in a substance with ub > 0
+	for(size_t j = 0; j != number.elements; ++j) {
+		if(b[j] <= 0) {
+			continue;
+		}
+		auto a_j = ordering->a.cbegin() + static_cast<std::ptrdiff_t>(j * number.substances);
+		bool is_found = false;
+		for(size_t k = 0; k != number.substances && !is_found; ++k) {
+			is_found = a_j[static_cast<std::ptrdiff_t>(k)] > 0 && ub[k] > 0;
+		}
+		if(!is_found) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool OptimizationItem::IsExistAtCurrentTemperature(const int index)
+{
+	auto&& temp_range = *context->substance_coefs[index];
+	auto min = temp_range.cbegin()->T_min;
+	auto max = temp_range.crbegin()->T_max;
+	if(min <= temperature_K_current && temperature_K_current <= max) {
+		return true;
+	} else {
+		return false;
+	}
+}
+
+Solver::Solver(const nlopt::algorithm algorithm_, const nlopt::vfunc function_,
+			   const size_t substances_, const size_t elements_)
+	: algorithm{algorithm_}
+	, function{function_}
+	, substances{substances_}
+	, elements{elements_}
+	, opt(algorithm_, static_cast<unsigned>(substances_))
+{
+	opt.set_lower_bounds(0);
+	opt.set_min_objective(function, &item);
+	opt.add_equality_mconstraint(Optimization::ConstraintsFunction, this,
+			std::vector<double>(elements, Optimization::epsilon_accuracy));
+	// Using ftol's results in a noisy graph.
+	/* bug in nlopt:
+	 * Class nlopt::opt has private struct nlopt_opt which has field
+	 * double *xtol_abs.
+	 * Nlopt library does not allocate memory for xtol_abs array by default.
+	 * When the NLOPT_LD_AUGLAG_EQ algorithm is used, the nlopt library creates
+	 * a local_opt instance of nlopt_opt struct for local optimization and uses
+	 * the memcpy function to copy some data from the primary opt to local_opt.
+	 * And memcpy try to copy from null pointer xtol_abs to another.
+	 * Since xtol_abs is not allocated in primary opt, the program crashes.
+	 * File optimize.c line 755 in function nlopt_optimize_ then
+	 * file option.c line 698 in function nlopt_set_xtol_abs.
+	 * Solution: use the set_xtol_abs function for the primary opt instance,
+	 * which will allocate the necessary memory.
+	 */
+	opt.set_xtol_abs(Optimization::epsilon_accuracy);
+	opt.set_xtol_rel(Optimization::epsilon_accuracy);
+	opt.set_maxtime(Optimization::maxtime_of_minimize);
+}
+
+static Solver& GetSolver(const nlopt::algorithm algorithm,
+						 const nlopt::vfunc function,
+						 const size_t substances, const size_t elements)
+{
+	constexpr size_t max_solvers = 16;
+	static thread_local std::vector<std::unique_ptr<Solver>> solvers;
+	auto it = std::find_if(solvers.begin(), solvers.end(),
+						   [=](const std::unique_ptr<Solver>& solver){
+		return solver->algorithm == algorithm && solver->function == function &&
+				solver->substances == substances && solver->elements == elements;
+	});
+	if(it != solvers.end()) {
+		return **it;
+	}
+	if(solvers.size() == max_solvers) {
+		solvers.erase(solvers.begin());
+	}
+	solvers.push_back(std::make_unique<Solver>(algorithm, function,
+											   substances, elements));
+	return *solvers.back();
+}
+
+// Equilibrium at constant H and P as one optimization in x = |n|T / T_scale|:
+// the minimum of -S/R subject to A n = b and H(n, T) = H_initial.
+// T is limited to a segment, so the order of substances is fixed.
+struct IsenthalpicSolver
+{
+	static constexpr double T_scale = 1000; // K
+	// a restart is cheaper than the stalled line search of SLSQP
+	static constexpr int maxeval_of_pass = 1000;
+	static constexpr int passes = 8;
+	size_t substances;
+	size_t elements;
+	const ProblemContext* context{nullptr};
+	const Segment* segment{nullptr};
+	const Ordering* ordering{nullptr};
+	const std::vector<double>* b{nullptr};
+	double H_initial{0};
+	// functions of the last temperature, s = -S/R
+	const TemperatureInterval* interval{nullptr};
+	double temperature_K{0};
+	Thermodynamics::PropertiesBlock properties;
+	std::vector<double> s;
+	nlopt::opt opt;
+	IsenthalpicSolver(const size_t substances_, const size_t elements_);
+	void Update(const double temperature_K_);
+};
+
+static double IsenthalpicObjective(const std::vector<double>& x,
+								   std::vector<double>& grad, void* data)
+{
+	auto&& solver = *reinterpret_cast<IsenthalpicSolver*>(data);
+	const size_t N = solver.substances;
+	solver.Update(x[N] * IsenthalpicSolver::T_scale);
+	double* g = grad.empty() ? nullptr : grad.data();
+	const double result = PhasesFunction(x.data(), solver.s.data(), g,
+										 *solver.ordering);
+	if(g) {
+		// dS/dT = Cp/T
+		g[N] = -std::transform_reduce(x.cbegin(), x.cbegin() + static_cast<std::ptrdiff_t>(N),
+									  solver.properties.Cp_J.cbegin(), double{0.0}) /
+				(Thermodynamics::R * solver.temperature_K) * IsenthalpicSolver::T_scale;
+	}
+	return result;
+}
+
+static void IsenthalpicConstraints(unsigned m, double* result, unsigned n,
+								   const double* x, double* grad, void* data)
+{
+	// result = |A * n - b|(H - H_initial) / (R * T_scale)|
+	auto&& solver = *reinterpret_cast<IsenthalpicSolver*>(data);
+	const size_t N = solver.substances;
+	const size_t M = solver.elements;
+	assert(m == M + 1 && n == N + 1);
+	solver.Update(x[N] * IsenthalpicSolver::T_scale);
+	auto&& a = solver.ordering->a;
+	auto&& b = *solver.b;
+	for(size_t j = 0; j != M; ++j) {
+		const double* a_j = a.data() + j * N;
+		double r = -b[j];
+		for(size_t k = 0; k != N; ++k) {
+			r += a_j[k] * x[k];
+		}
+		result[j] = r;
+		if(grad) {
+			std::copy(a_j, a_j + N, grad + j * n);
+			grad[j * n + N] = 0;
+		}
+	}
+	const double scale = 1.0E3 / (Thermodynamics::R * IsenthalpicSolver::T_scale);
+	auto&& H = solver.properties.H_kJ;
+	auto&& Cp = solver.properties.Cp_J;
+	result[M] = (std::transform_reduce(x, x + N, H.cbegin(), double{0.0}) -
+				 solver.H_initial) * scale;
+	if(grad) {
+		double* grad_H = grad + M * n;
+		std::transform(H.cbegin(), H.cend(), grad_H,
+					   [scale](const double h){ return h * scale; });
+		// dH/dT = Cp
+		grad_H[N] = std::transform_reduce(x, x + N, Cp.cbegin(), double{0.0}) /
+				Thermodynamics::R;
+	}
+}
+
+IsenthalpicSolver::IsenthalpicSolver(const size_t substances_,
+									 const size_t elements_)
+	: substances{substances_}
+	, elements{elements_}
+	, opt(nlopt::LD_SLSQP, static_cast<unsigned>(substances_ + 1))
+{
+	properties.Resize(substances);
+	s.resize(substances);
+	opt.set_min_objective(IsenthalpicObjective, this);
+	opt.add_equality_mconstraint(IsenthalpicConstraints, this,
+			std::vector<double>(elements + 1, Optimization::epsilon_accuracy));
+	opt.set_xtol_abs(Optimization::epsilon_accuracy);
+	opt.set_xtol_rel(Optimization::epsilon_accuracy);
+	opt.set_maxtime(Optimization::maxtime_of_minimize);
+	opt.set_maxeval(maxeval_of_pass);
+}
+
+void IsenthalpicSolver::Update(const double temperature_K_)
+{
+	if(temperature_K_ == temperature_K && interval) {
+		return;
+	}
+	temperature_K = temperature_K_;
+	// the ends of the segment belong to it, the functions are extrapolated
+	interval = &context->FindInterval(temperature_K, interval);
+	interval = std::clamp(interval, segment->first, segment->last);
+	context->kernels->interval(temperature_K, *context, *interval, *ordering,
+							   properties);
+	std::transform(properties.S_J.cbegin(), properties.S_J.cend(), s.begin(),
+				   [](const double S){ return -S / Thermodynamics::R; });
+}
+
+static IsenthalpicSolver& GetIsenthalpicSolver(const size_t substances,
+											   const size_t elements)
+{
+	constexpr size_t max_solvers = 4;
+	static thread_local std::vector<std::unique_ptr<IsenthalpicSolver>> solvers;
+	auto it = std::find_if(solvers.begin(), solvers.end(),
+						   [=](const std::unique_ptr<IsenthalpicSolver>& solver){
+		return solver->substances == substances && solver->elements == elements;
+	});
+	if(it != solvers.end()) {
+		return **it;
+	}
+	if(solvers.size() == max_solvers) {
+		solvers.erase(solvers.begin());
+	}
+	solvers.push_back(std::make_unique<IsenthalpicSolver>(substances, elements));
+	return *solvers.back();
+}
+
+bool OptimizationItem::IsenthalpicEquilibrium(const Segment& segment,
+											  double& temperature_K,
+											  double& residual_K,
+											  bool& is_feasible)
+{
+	// n of the current order is the start point, it is remapped by
+	// substance to the order of the segment
+	std::vector<double> amounts(number.substances);
+	for(size_t k = 0; k != number.substances; ++k) {
+		amounts[static_cast<size_t>(ordering->order[k])] = n[k];
+	}
+	temperature_K_current = (segment.T_min + segment.T_max) / 2;
+	DefineOrderOfSubstances();
+	MakeUB();
+	std::transform(ordering->order.cbegin(), ordering->order.cend(), ub.cbegin(),
+				   n.begin(), [&amounts](const int i, const double ubi){
+		return std::clamp(amounts[static_cast<size_t>(i)], 0.0, ubi); });
+	is_feasible = IsFeasible();
+	if(!is_feasible) {
+		return false;
+	}
+	const auto N = number.substances;
+	constexpr double T_scale = IsenthalpicSolver::T_scale;
+	std::vector<double> x(n), lb(N + 1, 0.0), ub_x(ub);
+	x.push_back(0);
+	x[N] = std::clamp(temperature_K, segment.T_min, segment.T_max) / T_scale;
+	lb[N] = segment.T_min / T_scale;
+	ub_x.push_back(segment.T_max / T_scale);
+
+	auto&& solver = GetIsenthalpicSolver(N, number.elements);
+	solver.context = context.get();
+	solver.segment = &segment;
+	solver.ordering = ordering;
+	solver.b = &b;
+	solver.H_initial = H_initial;
+	solver.interval = nullptr;
+	auto&& opt = solver.opt;
+	opt.set_lower_bounds(lb);
+	opt.set_upper_bounds(ub_x);
+	residual_K = 0;
+	double minf;
+	try {
+		// SLSQP tends to stop early along T, restart it from its own result
+		const double at_epsilon = std::pow(10, -context->parameters.at_accuracy)/2;
+		for(int pass = 0; pass != IsenthalpicSolver::passes; ++pass) {
+			const double T_previous = x[N];
+			const auto result = opt.optimize(x, minf);
+			if(result < 0) {
+				return false;
+			}
+			if(result != nlopt::MAXEVAL_REACHED &&
+					std::abs(x[N] - T_previous) * T_scale <= at_epsilon) {
+				break;
+			}
+		}
+	}
+	catch(std::exception&) {
+		return false;
+	}
+	std::copy(x.cbegin(), x.cend() - 1, n.begin());
+	temperature_K = x[N] * T_scale;
+	solver.Update(temperature_K);
+	auto&& p = solver.properties;
+	const double H = std::transform_reduce(n.cbegin(), n.cend(), p.H_kJ.cbegin(),
+										   double{0.0});
+	const double Cp = 1.0E-3 * std::transform_reduce(n.cbegin(), n.cend(),
+													 p.Cp_J.cbegin(), double{0.0});
+	residual_K = (H - H_initial) / std::max(Cp, Optimization::epsilon_accuracy);
+	return true;
+}
+
+// Gaussian elimination with partial pivoting, the matrix is destroyed and
+// x is the right side and the solution. False if the matrix is singular.
+static bool SolveLinearSystem(std::vector<double>& matrix, std::vector<double>& x,
+							  const size_t size)
+{
+	constexpr double epsilon_pivot = 1.0E-13;
+	double norm = 0;
+	for(const auto value : matrix) {
+		norm = std::max(norm, std::abs(value));
+	}
+	for(size_t i = 0; i != size; ++i) {
+		size_t pivot = i;
+		for(size_t r = i + 1; r != size; ++r) {
+			if(std::abs(matrix[r * size + i]) > std::abs(matrix[pivot * size + i])) {
+				pivot = r;
+			}
+		}
+		if(!(std::abs(matrix[pivot * size + i]) > epsilon_pivot * norm)) {
+			return false;
+		}
+		if(pivot != i) {
+			std::swap_ranges(matrix.begin() + static_cast<std::ptrdiff_t>(i * size),
+							 matrix.begin() + static_cast<std::ptrdiff_t>((i + 1) * size),
+							 matrix.begin() + static_cast<std::ptrdiff_t>(pivot * size));
+			std::swap(x[i], x[pivot]);
+		}
+		const double* row_i = matrix.data() + i * size;
+		for(size_t r = i + 1; r != size; ++r) {
+			double* row_r = matrix.data() + r * size;
+			const double factor = row_r[i] / row_i[i];
+			if(factor == 0) {
+				continue;
+			}
+			for(size_t k = i; k != size; ++k) {
+				row_r[k] -= factor * row_i[k];
+			}
+			x[r] -= factor * x[i];
+		}
+	}
+	for(size_t i = size; i-- != 0;) {
+		const double* row_i = matrix.data() + i * size;
+		double sum = x[i];
+		for(size_t k = i + 1; k != size; ++k) {
+			sum -= row_i[k] * x[k];
+		}
+		x[i] = sum / row_i[i];
+	}
+	return true;
+}
+
+// Minimum of G of the ideal gas, the ideal liquid solution and the individual
+// substances by the RAND method with element potentials, as in NASA CEA
+// (Gordon, McBride, NASA RP-1311). The unknowns of Newton's step are
+// the element potentials pi, the changes of the moles of the present mixtures
+// and the changes of n of the present individual substances:
+// d ln n_k = d ln N_p + sum_j a_jk pi_j - mu_k, mu_k = c_k + ln(n_k / N_p)
+// for the species of mixture p and sum_j a_jk pi_j = c_k for the individuals.
+// A phase is excluded when its amount becomes negative or the system becomes
+// singular, e.g. by the phase rule, and it is included when it is unstable
+// at the converged pi. If the present individuals do not define pi, e.g. they
+// are stoichiometric, a mixture stays at the floor amount with its
+// equilibrium composition. The solver fails instead of cycling, then nlopt
+// is used.
+struct ElementPotentialSolver
+{
+	static constexpr size_t mixtures = 2;	// the gas and the liquid solution
+	static constexpr int max_iterations = 500;
+	static constexpr int max_phase_changes = 50;
+	static constexpr double epsilon = 1.0E-10;	// relative to the moles of atoms
+	static constexpr double epsilon_stability = 1.0E-9;
+	static constexpr double ln_trace = -18.420681;	// ln(1e-8), mole fraction
+	static constexpr double ln_limit = -9.2103404;	// ln(1e-4)
+	static constexpr double ln_floor = -50;	// relative to the moles of atoms
+
+	// the problem in the current order
+	size_t N{0};
+	size_t M{0};
+	size_t begin[mixtures + 1]{};	// of the gas, the liquid solution, the individuals
+	const double* a{nullptr};
+	const double* b{nullptr};
+	const double* c{nullptr};
+	const double* ub{nullptr};
+	// the state, ln_n of the mixtures and n of the individuals
+	std::vector<size_t> elements;	// with b > 0
+	std::vector<double> ln_n, n, fraction, mu, pi;
+	std::vector<char> is_present;	// of the individuals
+	bool is_mixture_present[mixtures]{};
+	double ln_moles[mixtures]{};
+	double scale{0};	// moles of atoms
+	double ln_min{0};
+	size_t last_included{0};
+	size_t last_excluded{0};
+	// Newton's step, the phases are N + p for mixture p and k for individual k
+	std::vector<size_t> phases;
+	std::vector<double> matrix, x;
+	double residual{0};
+
+	void Prepare(const Ordering& ordering, const std::vector<double>& b_,
+				 const std::vector<double>& c_, const std::vector<double>& ub_);
+	bool Solve(std::vector<double>& amounts, const bool has_start);
+private:
+	enum class Step { Continue, Converged, Excluded };
+	size_t MixtureOf(const size_t k) const { return k < begin[1] ? 0 : 1; }
+	bool IsPresent(const size_t k) const {
+		return k < begin[mixtures] ? is_mixture_present[MixtureOf(k)] : is_present[k];
+	}
+	double Potential(const size_t k) const;
+	bool HasSpecies(const size_t p) const;
+	double LnStability(const size_t p) const;
+	bool Start(const std::vector<double>& amounts, const bool has_start);
+	bool IsCovered(const size_t without) const;
+	bool Cover();
+	void Mixtures();
+	bool Newton();
+	Step Update();
+	bool Include();
+	bool IncludeMixture(const size_t p);
+	bool Exclude();
+	bool Singular();
+};
+
+void ElementPotentialSolver::Prepare(const Ordering& ordering,
+									 const std::vector<double>& b_,
+									 const std::vector<double>& c_,
+									 const std::vector<double>& ub_)
+{
+	N = ordering.order.size();
+	M = b_.size();
+	begin[0] = 0;
+	begin[1] = ordering.gases;
+	begin[2] = ordering.gases + ordering.liquids;
+	a = ordering.a.data();
+	b = b_.data();
+	c = c_.data();
+	ub = ub_.data();
+}
+
+double ElementPotentialSolver::Potential(const size_t k) const
+{
+	double sum = 0;
+	for(size_t r = 0, size = elements.size(); r != size; ++r) {
+		sum += a[elements[r] * N + k] * pi[r];
+	}
+	return sum;
+}
+
+bool ElementPotentialSolver::HasSpecies(const size_t p) const
+{
+	for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+		if(ub[k] > 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+double ElementPotentialSolver::LnStability(const size_t p) const
+{
+	// ln(sum of exp(pi a_k - c_k)), the mixture is unstable if it is positive,
+	// the mixture without the species is the most stable one
+	bool has_species = false;
+	double max = std::numeric_limits<double>::lowest();
+	for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+		if(ub[k] > 0) {
+			max = has_species ? std::max(max, Potential(k) - c[k]) :
+								Potential(k) - c[k];
+			has_species = true;
+		}
+	}
+	if(!has_species) {
+		return std::numeric_limits<double>::lowest();
+	}
+	double sum = 0;
+	for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+		if(ub[k] > 0) {
+			sum += std::exp(Potential(k) - c[k] - max);
+		}
+	}
+	return max + std::log(sum);
+}
+
+bool ElementPotentialSolver::Start(const std::vector<double>& amounts,
+								   const bool has_start)
+{
+	elements.clear();
+	scale = 0;
+	for(size_t j = 0; j != M; ++j) {
+		if(b[j] > 0) {
+			elements.push_back(j);
+			scale += b[j];
+		}
+	}
+	ln_n.assign(N, 0);
+	n.assign(N, 0);
+	fraction.assign(N, 0);
+	mu.assign(N, 0);
+	pi.assign(elements.size(), 0);
+	is_present.assign(N, 0);
+	last_included = N + mixtures;
+	last_excluded = N + mixtures;
+	if(elements.empty()) {
+		return true;
+	}
+	ln_min = std::log(scale) + ln_floor;
+	for(size_t p = 0; p != mixtures; ++p) {
+		bool is_active = false;
+		double sum = 0;
+		for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+			ln_n[k] = amounts[k] > 0 ? std::max(std::log(amounts[k]), ln_min) : ln_min;
+			if(ub[k] > 0) {
+				is_active = true;
+				sum += amounts[k];
+			}
+		}
+		is_mixture_present[p] = is_active && (!has_start || sum > epsilon * scale);
+	}
+	for(size_t k = begin[mixtures]; k != N; ++k) {
+		is_present[k] = has_start && ub[k] > 0 && amounts[k] > epsilon * scale;
+		n[k] = is_present[k] ? amounts[k] : 0;
+	}
+	return Cover();
+}
+
+bool ElementPotentialSolver::IsCovered(const size_t without) const
+{
+	// each element is in a present phase except the phase without
+	for(const auto j : elements) {
+		const double* a_j = a + j * N;
+		bool is_covered = false;
+		for(size_t k = 0; k != N && !is_covered; ++k) {
+			const auto phase = k < begin[mixtures] ? N + MixtureOf(k) : k;
+			is_covered = a_j[k] > 0 && ub[k] > 0 && IsPresent(k) && phase != without;
+		}
+		if(!is_covered) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ElementPotentialSolver::Cover()
+{
+	// each element is in a present phase, else the cheapest individual
+	// per atom or the mixture is included
+	for(const auto j : elements) {
+		const double* a_j = a + j * N;
+		bool is_covered = false;
+		for(size_t k = 0; k != N && !is_covered; ++k) {
+			is_covered = a_j[k] > 0 && ub[k] > 0 && IsPresent(k);
+		}
+		if(is_covered) {
+			continue;
+		}
+		size_t best = N;
+		double best_value = 0;
+		for(size_t k = begin[mixtures]; k != N; ++k) {
+			if(a_j[k] > 0 && ub[k] > 0) {
+				double atoms = 0;
+				for(const auto i : elements) {
+					atoms += a[i * N + k];
+				}
+				if(best == N || c[k] / atoms < best_value) {
+					best_value = c[k] / atoms;
+					best = k;
+				}
+			}
+		}
+		if(best != N) {
+			is_present[best] = 1;
+			continue;
+		}
+		for(size_t k = 0; k != begin[mixtures] && !is_covered; ++k) {
+			if(a_j[k] > 0 && ub[k] > 0) {
+				is_mixture_present[MixtureOf(k)] = true;
+				is_covered = true;
+			}
+		}
+		if(!is_covered) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void ElementPotentialSolver::Mixtures()
+{
+	for(size_t p = 0; p != mixtures; ++p) {
+		bool has_species = false;
+		double max = std::numeric_limits<double>::lowest();
+		for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+			if(ub[k] > 0) {
+				max = has_species ? std::max(max, ln_n[k]) : ln_n[k];
+				has_species = true;
+			}
+		}
+		if(!has_species) {
+			ln_moles[p] = std::numeric_limits<double>::lowest();
+			for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+				n[k] = 0;
+				fraction[k] = 0;
+				mu[k] = c[k];
+			}
+			continue;
+		}
+		double sum = 0;
+		for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+			if(ub[k] > 0) {
+				sum += std::exp(ln_n[k] - max);
+			}
+		}
+		ln_moles[p] = max + std::log(sum);
+		for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+			const bool is_species = is_mixture_present[p] && ub[k] > 0;
+			n[k] = is_species ? std::exp(ln_n[k]) : 0;
+			fraction[k] = is_species ? std::exp(ln_n[k] - ln_moles[p]) : 0;
+			mu[k] = c[k] + ln_n[k] - ln_moles[p];
+		}
+	}
+}
+
+bool ElementPotentialSolver::Newton()
+{
+	// the rows are the elements, the mixtures and the individuals,
+	// the rows of the mixtures are divided by their moles, so the columns
+	// of the mixtures are the changes of the moles
+	phases.clear();
+	for(size_t p = 0; p != mixtures; ++p) {
+		if(is_mixture_present[p]) {
+			phases.push_back(N + p);
+		}
+	}
+	for(size_t k = begin[mixtures]; k != N; ++k) {
+		if(is_present[k]) {
+			phases.push_back(k);
+		}
+	}
+	const size_t E = elements.size();
+	const size_t S = E + phases.size();
+	matrix.assign(S * S, 0.0);
+	x.assign(S, 0.0);
+	residual = 0;
+	for(size_t r = 0; r != E; ++r) {
+		const double* a_j = a + elements[r] * N;
+		double* row = matrix.data() + r * S;
+		double balance = b[elements[r]];
+		double rhs = balance;
+		for(size_t q = 0, size = phases.size(); q != size; ++q) {
+			const auto phase = phases[q];
+			if(phase < N) {
+				row[E + q] = a_j[phase];
+				balance -= a_j[phase] * n[phase];
+				rhs -= a_j[phase] * n[phase];
+				continue;
+			}
+			const auto p = phase - N;
+			for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+				if(a_j[k] == 0 || ub[k] <= 0) {
+					continue;
+				}
+				balance -= a_j[k] * n[k];
+				rhs += a_j[k] * n[k] * (mu[k] - 1);
+				row[E + q] += a_j[k] * fraction[k];
+				for(size_t r2 = 0; r2 != E; ++r2) {
+					row[r2] += a_j[k] * a[elements[r2] * N + k] * n[k];
+				}
+			}
+		}
+		x[r] = rhs;
+		residual = std::max(residual, std::abs(balance));
+	}
+	for(size_t q = 0, size = phases.size(); q != size; ++q) {
+		const auto i = E + q;
+		for(size_t r = 0; r != E; ++r) {
+			matrix[i * S + r] = matrix[r * S + i];
+		}
+		const auto phase = phases[q];
+		if(phase < N) {
+			x[i] = c[phase];
+		} else {
+			const auto p = phase - N;
+			double rhs = 0;
+			for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+				rhs += fraction[k] * mu[k];
+			}
+			x[i] = rhs;
+		}
+	}
+	return SolveLinearSystem(matrix, x, S);
+}
+
+ElementPotentialSolver::Step ElementPotentialSolver::Update()
+{
+	const size_t E = elements.size();
+	const double tolerance = epsilon * scale;
+	std::copy(x.cbegin(), x.cbegin() + static_cast<std::ptrdiff_t>(E), pi.begin());
+	bool is_converged = residual <= tolerance;
+	// the mixture at the floor has the equilibrium composition at pi and
+	// the linear change of its moles, its ln is not defined by the step
+	double d_moles[mixtures]{};
+	double d_ln_moles[mixtures]{};
+	bool is_floor[mixtures]{};
+	double max_step = 0;
+	for(size_t q = 0, size = phases.size(); q != size; ++q) {
+		const auto phase = phases[q];
+		const double d = x[E + q];
+		is_converged = is_converged && std::abs(d) <= tolerance;
+		if(phase < N) {
+			continue;
+		}
+		const auto p = phase - N;
+		d_moles[p] = d;
+		d_ln_moles[p] = d * std::exp(-ln_moles[p]);
+		is_floor[p] = ln_moles[p] < ln_min + 1;
+		if(!is_floor[p]) {
+			max_step = std::max(max_step, d_ln_moles[p]);
+		}
+	}
+	// the mixture vanishes by the linear step as the negative individuals,
+	// the last one is kept at the floor if the individuals do not define pi,
+	// e.g. the stoichiometric ones, then pi is on its stability boundary
+	size_t vanishing = mixtures;
+	size_t present = 0;
+	for(size_t p = 0; p != mixtures; ++p) {
+		present += is_mixture_present[p];
+		if(is_mixture_present[p] && !is_floor[p] && 1 + d_ln_moles[p] < 1.0E-2 &&
+				!is_converged &&
+				(vanishing == mixtures || d_ln_moles[p] < d_ln_moles[vanishing])) {
+			vanishing = p;
+		}
+	}
+	if(vanishing != mixtures && !IsCovered(N + vanishing)) {
+		vanishing = mixtures;
+	}
+	if(vanishing != mixtures && (present > 1 || phases.size() > E)) {
+		is_mixture_present[vanishing] = false;
+		last_excluded = N + vanishing;
+		return Step::Excluded;
+	}
+	// the step is limited as in CEA: the major species increase at most
+	// by e^2 and the trace species reach at most the mole fraction 1e-4
+	double lambda = 1;
+	for(size_t p = 0; p != mixtures; ++p) {
+		if(!is_mixture_present[p]) {
+			continue;
+		}
+		if(p == vanishing) {
+			is_floor[p] = true;
+			d_moles[p] = 0;
+		}
+		for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+			if(ub[k] <= 0) {
+				continue;
+			}
+			const double d = d_ln_moles[p] + Potential(k) - mu[k];
+			mu[k] = d;	// mu is not needed after the step
+			const double ln_fraction = ln_n[k] - ln_moles[p];
+			is_converged = is_converged && n[k] * std::abs(d) <= tolerance &&
+					std::exp(ln_fraction) * std::abs(d - d_ln_moles[p]) <= epsilon_stability;
+			if(is_floor[p]) {
+				continue;
+			}
+			if(ln_fraction > ln_trace) {
+				max_step = std::max(max_step, d);
+			} else if(d - d_ln_moles[p] > 0) {
+				lambda = std::min(lambda, std::abs((ln_limit - ln_fraction) /
+												   (d - d_ln_moles[p])));
+			}
+		}
+	}
+	if(max_step > 2) {
+		lambda = std::min(lambda, 2 / max_step);
+	}
+	// the moles of the mixture are limited by the floor with its composition
+	for(size_t p = 0; p != mixtures; ++p) {
+		if(!is_mixture_present[p]) {
+			continue;
+		}
+		if(is_floor[p]) {
+			const double moles = std::exp(ln_moles[p]) + lambda * d_moles[p];
+			const double ln_moles_new = p == vanishing || moles <= std::exp(ln_min) ?
+						ln_min : std::log(moles);
+			const double ln_stability = LnStability(p);
+			for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+				ln_n[k] = std::max(ln_moles_new + Potential(k) - c[k] - ln_stability,
+								   ln_min + ln_floor);
+			}
+			continue;
+		}
+		double max = std::numeric_limits<double>::lowest();
+		for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+			if(ub[k] > 0) {
+				ln_n[k] = std::max(ln_n[k] + lambda * mu[k], ln_min + ln_floor);
+				max = std::max(max, ln_n[k]);
+			}
+		}
+		double sum = 0;
+		for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+			if(ub[k] > 0) {
+				sum += std::exp(ln_n[k] - max);
+			}
+		}
+		const double shift = ln_min - max - std::log(sum);
+		if(shift > 0) {
+			for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+				ln_n[k] += shift;
+			}
+		}
+	}
+	if(vanishing != mixtures) {
+		return Step::Continue;	// the individuals by the next step
+	}
+	size_t negative = N;
+	for(size_t q = 0, size = phases.size(); q != size; ++q) {
+		const auto k = phases[q];
+		if(k < N) {
+			n[k] += lambda * x[E + q];
+			if(n[k] < 0 && (negative == N || n[k] < n[negative])) {
+				negative = k;
+			}
+		}
+	}
+	if(negative == N) {
+		return is_converged ? Step::Converged : Step::Continue;
+	}
+	for(size_t k = begin[mixtures]; k != N; ++k) {
+		n[k] = std::max(n[k], 0.0);
+	}
+	if(is_converged) {
+		return Step::Converged;
+	}
+	is_present[negative] = 0;
+	last_excluded = negative;
+	return Step::Excluded;
+}
+
+bool ElementPotentialSolver::Include()
+{
+	// the most unstable phase at pi, the driving force of an individual is
+	// c - pi a and of a mixture is -ln(sum of exp(pi a - c))
+	size_t chosen = N + mixtures;
+	double best = -epsilon_stability;
+	for(size_t k = begin[mixtures]; k != N; ++k) {
+		if(!is_present[k] && ub[k] > 0) {
+			const double force = c[k] - Potential(k);
+			if(force < best) {
+				best = force;
+				chosen = k;
+			}
+		}
+	}
+	for(size_t p = 0; p != mixtures; ++p) {
+		if(is_mixture_present[p] || begin[p] == begin[p + 1]) {
+			continue;
+		}
+		const double force = -LnStability(p);
+		if(force < best) {
+			best = force;
+			chosen = N + p;
+		}
+	}
+	if(chosen == N + mixtures) {
+		return false;
+	}
+	last_included = chosen;
+	if(chosen >= N) {
+		return IncludeMixture(chosen - N);
+	}
+	// an individual of the same composition, e.g. another modification,
+	// is replaced
+	is_present[chosen] = 1;
+	n[chosen] = 0;
+	for(size_t k = begin[mixtures]; k != N; ++k) {
+		if(!is_present[k] || k == chosen) {
+			continue;
+		}
+		const double ratio = CompositionRatio(a, M, N, k, chosen);
+		if(ratio > 0) {
+			n[chosen] += n[k] * ratio;
+			n[k] = 0;
+			is_present[k] = 0;
+		}
+	}
+	return true;
+}
+
+bool ElementPotentialSolver::IncludeMixture(const size_t p)
+{
+	// the composition of the mixture is the equilibrium at pi
+	const double ln_stability = LnStability(p);
+	is_mixture_present[p] = true;
+	for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+		ln_n[k] = std::max(std::log(scale) + ln_limit + Potential(k) - c[k] -
+						   ln_stability, ln_min + ln_floor);
+	}
+	return true;
+}
+
+bool ElementPotentialSolver::Exclude()
+{
+	// the singular system has more phases than allowed by the phase rule or
+	// a mixture of the composition of the individuals, the smallest mixture
+	// or else the first individual is excluded except the last included one
+	size_t chosen = N + mixtures;
+	double smallest = 0;
+	for(size_t p = 0; p != mixtures; ++p) {
+		if(is_mixture_present[p] && N + p != last_included &&
+				(chosen == N + mixtures || ln_moles[p] < std::log(smallest))) {
+			smallest = std::exp(ln_moles[p]);
+			chosen = N + p;
+		}
+	}
+	for(size_t k = begin[mixtures]; k != N && chosen == N + mixtures; ++k) {
+		if(is_present[k] && k != last_included) {
+			chosen = k;
+		}
+	}
+	if(chosen == N + mixtures) {
+		return false;
+	}
+	last_excluded = chosen;
+	if(chosen >= N) {
+		is_mixture_present[chosen - N] = false;
+	} else {
+		is_present[chosen] = 0;
+		n[chosen] = 0;
+	}
+	return true;
+}
+
+bool ElementPotentialSolver::Singular()
+{
+	// too few phases do not define pi, then the most stable absent mixture
+	// is included, the last excluded one at the last, else a phase is excluded
+	if(phases.size() < elements.size()) {
+		size_t chosen = mixtures;
+		double best = 0;
+		for(size_t p = 0; p != mixtures; ++p) {
+			if(is_mixture_present[p] || !HasSpecies(p)) {
+				continue;
+			}
+			const double ln_stability = N + p == last_excluded ?
+						std::numeric_limits<double>::lowest() : LnStability(p);
+			if(chosen == mixtures || ln_stability > best) {
+				best = ln_stability;
+				chosen = p;
+			}
+		}
+		if(chosen != mixtures) {
+			last_included = N + chosen;
+			return IncludeMixture(chosen);
+		}
+		// without the mixtures the degenerate basis of the individuals is
+		// completed by the cheapest one at zero amount
+		chosen = N;
+		for(size_t k = begin[mixtures]; k != N; ++k) {
+			if(!is_present[k] && ub[k] > 0 && k != last_excluded &&
+					(chosen == N || c[k] - Potential(k) < best)) {
+				best = c[k] - Potential(k);
+				chosen = k;
+			}
+		}
+		if(chosen != N) {
+			last_included = chosen;
+			is_present[chosen] = 1;
+			n[chosen] = 0;
+			return true;
+		}
+	}
+	return Exclude() && Cover();
+}
+
+bool ElementPotentialSolver::Solve(std::vector<double>& amounts,
+								   const bool has_start)
+{
+	if(!Start(amounts, has_start)) {
+		return false;
+	}
+	if(elements.empty()) {
+		std::fill(amounts.begin(), amounts.end(), 0.0);
+		return true;
+	}
+	int phase_changes = 0;
+	for(int i = 0; i != max_iterations; ++i) {
+		Mixtures();
+		if(!Newton()) {
+			if(++phase_changes > max_phase_changes || !Singular()) {
+				return false;
+			}
+			continue;
+		}
+		const auto step = Update();
+		if(step == Step::Continue) {
+			continue;
+		}
+		if(step == Step::Converged && !Include()) {
+			Mixtures();
+			for(size_t k = 0; k != N; ++k) {
+				amounts[k] = std::min(IsPresent(k) ? n[k] : 0.0, ub[k]);
+			}
+			return true;
+		}
+		if(++phase_changes > max_phase_changes || !Cover()) {
+			return false;
+		}
+	}
+	return false;
+}
+
+bool OptimizationItem::MinimizeByElementPotentials()
+{
+	static thread_local ElementPotentialSolver solver;
+	solver.Prepare(*ordering, b, c, ub);
+	if(!solver.Solve(n, start_point != nullptr)) {
+		return false;
+	}
+	const OptimizationItem* self = this;
+	std::vector<double> grad;
+	result_of_optimization = context->kernels->objective(n, grad, &self);
+	return true;
+}
+
+// by Lawson and Hanson, the passive set grows by the largest component
+// of the gradient A^T (rhs - A y)
+bool NonNegativeLeastSquares(const std::vector<double>& columns,
+							 const std::vector<double>& rhs,
+							 const size_t rows, const size_t cols,
+							 std::vector<double>& y)
+{
+	constexpr double epsilon = 1.0E-12;
+	double norm = 0;
+	for(const auto value : rhs) {
+		norm += std::abs(value);
+	}
+	const double tolerance = epsilon * std::max(norm, 1.0);
+	y.assign(cols, 0.0);
+	std::vector<char> is_passive(cols, 0);
+	std::vector<size_t> passive;
+	std::vector<double> residual(rows), z(cols), matrix, x;
+	const auto Column = [&](const size_t q){ return columns.data() + q * rows; };
+	for(size_t outer = 0; outer != 3 * cols + 3; ++outer) {
+		residual = rhs;
+		for(size_t q = 0; q != cols; ++q) {
+			const double* a_q = Column(q);
+			for(size_t r = 0; r != rows; ++r) {
+				residual[r] -= a_q[r] * y[q];
+			}
+		}
+		size_t best = cols;
+		double best_w = tolerance;
+		for(size_t q = 0; q != cols; ++q) {
+			if(is_passive[q]) {
+				continue;
+			}
+			const double w = std::inner_product(residual.cbegin(), residual.cend(),
+												Column(q), double{0.0});
+			if(w > best_w) {
+				best_w = w;
+				best = q;
+			}
+		}
+		if(best == cols) {
+			return true;
+		}
+		is_passive[best] = 1;
+		for(size_t inner = 0; inner != cols + 1; ++inner) {
+			// the unconstrained least squares on the passive set
+			passive.clear();
+			for(size_t q = 0; q != cols; ++q) {
+				if(is_passive[q]) {
+					passive.push_back(q);
+				}
+			}
+			const size_t size = passive.size();
+			matrix.assign(size * size, 0.0);
+			x.assign(size, 0.0);
+			for(size_t i = 0; i != size; ++i) {
+				const double* a_i = Column(passive[i]);
+				for(size_t l = 0; l != size; ++l) {
+					matrix[i * size + l] = std::inner_product(a_i, a_i + rows,
+							Column(passive[l]), double{0.0});
+				}
+				x[i] = std::inner_product(a_i, a_i + rows, rhs.cbegin(), double{0.0});
+			}
+			if(!SolveLinearSystem(matrix, x, size)) {
+				return false;
+			}
+			std::fill(z.begin(), z.end(), 0.0);
+			bool is_positive = true;
+			for(size_t i = 0; i != size; ++i) {
+				z[passive[i]] = x[i];
+				is_positive = is_positive && x[i] > 0;
+			}
+			if(is_positive) {
+				y = z;
+				break;
+			}
+			// back to the feasible region, the zeros leave the passive set
+			double alpha = 1;
+			for(const auto q : passive) {
+				if(z[q] <= 0) {
+					alpha = std::min(alpha, y[q] / (y[q] - z[q]));
+				}
+			}
+			for(const auto q : passive) {
+				y[q] += alpha * (z[q] - y[q]);
+				if(y[q] <= tolerance) {
+					y[q] = 0;
+					is_passive[q] = 0;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// Minimum of G of the ideal gas, the ideal liquid solution and the individual
+// substances by the dual problem in the element potentials pi of the elements
+// with b > 0: the maximum of b pi subject to ln(sum of exp(pi a_k - c_k)) <= 0
+// for each mixture and pi a_k <= c_k for each individual. There are as many
+// variables as elements. The amounts are the Lagrange multipliers: the mixture
+// of moles N_p has n_k = N_p exp(pi a_k - c_k) and the moles of the active
+// phases are found from the balance of elements.
+struct DualSolver
+{
+	static constexpr size_t mixtures = 2;	// the gas and the liquid solution
+	static constexpr double epsilon_pi = 1.0E-12;
+	static constexpr double epsilon_constraint = 1.0E-10;
+	static constexpr double epsilon_active = 1.0E-6;
+	static constexpr double epsilon_regularization = 1.0E-10;
+	static constexpr int maxeval = 1000;
+	size_t elements;	// with b > 0
+	size_t constraints;	// the mixtures and the individuals
+	// the problem in the current order
+	size_t N{0};
+	size_t M{0};
+	size_t begin[mixtures + 1]{};
+	const double* a{nullptr};
+	const double* c{nullptr};
+	std::vector<size_t> rows;	// the elements with b > 0
+	std::vector<double> b;	// of the rows
+	std::vector<char> is_active;	// the substances which can exist
+	double scale{0};	// moles of atoms
+	nlopt::opt opt;
+
+	DualSolver(const size_t elements_, const size_t constraints_);
+	double Potential(const double* pi, const size_t k) const;
+	double LnStability(const double* pi, const size_t p, double* grad) const;
+	bool Solve(const Ordering& ordering, const std::vector<double>& b_,
+			   const std::vector<double>& c_, const std::vector<double>& ub,
+			   std::vector<double>& amounts);
+private:
+	bool IsDominated(const size_t k) const;
+	void Columns(const std::vector<double>& pi, const std::vector<size_t>& phases,
+				 std::vector<double>& columns) const;
+	bool Recover(const std::vector<double>& pi, const bool with_mixtures,
+				 std::vector<size_t>& phases, std::vector<double>& moles) const;
+	void Polish(std::vector<double>& pi, const std::vector<size_t>& phases,
+				std::vector<double>& moles) const;
+};
+
+static double DualObjective(unsigned n, const double* x, double* grad, void* data)
+{
+	// -b pi / moles of atoms
+	auto&& solver = *reinterpret_cast<DualSolver*>(data);
+	double result = 0;
+	for(unsigned r = 0; r != n; ++r) {
+		result -= solver.b[r] * x[r] / solver.scale;
+		if(grad) {
+			grad[r] = -solver.b[r] / solver.scale;
+		}
+	}
+	return result;
+}
+
+static void DualConstraints(unsigned m, double* result, unsigned n,
+							const double* x, double* grad, void* data)
+{
+	// the mixtures then the individuals, the substances which can not exist
+	// give the constant -1
+	auto&& solver = *reinterpret_cast<DualSolver*>(data);
+	const size_t mixtures = DualSolver::mixtures;
+	assert(m == solver.constraints && n == solver.elements);
+	for(size_t p = 0; p != mixtures; ++p) {
+		result[p] = solver.LnStability(x, p, grad ? grad + p * n : nullptr);
+	}
+	for(size_t q = mixtures; q != m; ++q) {
+		const size_t k = solver.begin[mixtures] + q - mixtures;
+		double* grad_q = grad ? grad + q * n : nullptr;
+		if(!solver.is_active[k]) {
+			result[q] = -1;
+			if(grad_q) {
+				std::fill(grad_q, grad_q + n, 0.0);
+			}
+			continue;
+		}
+		result[q] = solver.Potential(x, k) - solver.c[k];
+		if(grad_q) {
+			for(size_t r = 0; r != n; ++r) {
+				grad_q[r] = solver.a[solver.rows[r] * solver.N + k];
+			}
+		}
+	}
+}
+
+DualSolver::DualSolver(const size_t elements_, const size_t constraints_)
+	: elements{elements_}
+	, constraints{constraints_}
+	, opt(nlopt::LD_SLSQP, static_cast<unsigned>(elements_))
+{
+	opt.set_min_objective(DualObjective, this);
+	opt.add_inequality_mconstraint(DualConstraints, this,
+			std::vector<double>(constraints, epsilon_constraint));
+	opt.set_xtol_abs(epsilon_pi);
+	opt.set_xtol_rel(epsilon_pi);
+	opt.set_maxtime(Optimization::maxtime_of_minimize);
+	opt.set_maxeval(maxeval);
+}
+
+double DualSolver::Potential(const double* pi, const size_t k) const
+{
+	double sum = 0;
+	for(size_t r = 0; r != elements; ++r) {
+		sum += a[rows[r] * N + k] * pi[r];
+	}
+	return sum;
+}
+
+double DualSolver::LnStability(const double* pi, const size_t p, double* grad) const
+{
+	// ln(sum of exp(pi a_k - c_k)), the gradient is the composition at pi
+	if(grad) {
+		std::fill(grad, grad + elements, 0.0);
+	}
+	// the mixture without the active species satisfies the constraint
+	bool has_species = false;
+	double max = 0;
+	for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+		if(is_active[k]) {
+			max = has_species ? std::max(max, Potential(pi, k) - c[k]) :
+								Potential(pi, k) - c[k];
+			has_species = true;
+		}
+	}
+	if(!has_species) {
+		return -1;
+	}
+	double sum = 0;
+	for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+		if(!is_active[k]) {
+			continue;
+		}
+		const double w = std::exp(Potential(pi, k) - c[k] - max);
+		sum += w;
+		if(grad) {
+			for(size_t r = 0; r != elements; ++r) {
+				grad[r] += w * a[rows[r] * N + k];
+			}
+		}
+	}
+	if(grad) {
+		for(size_t r = 0; r != elements; ++r) {
+			grad[r] /= sum;
+		}
+	}
+	return max + std::log(sum);
+}
+
+bool DualSolver::Solve(const Ordering& ordering, const std::vector<double>& b_,
+					   const std::vector<double>& c_, const std::vector<double>& ub,
+					   std::vector<double>& amounts)
+{
+	N = ordering.order.size();
+	begin[0] = 0;
+	begin[1] = ordering.gases;
+	begin[2] = ordering.gases + ordering.liquids;
+	a = ordering.a.data();
+	c = c_.data();
+	M = b_.size();
+	rows.clear();
+	b.clear();
+	scale = 0;
+	for(size_t j = 0; j != M; ++j) {
+		if(b_[j] > 0) {
+			rows.push_back(j);
+			b.push_back(b_[j]);
+			scale += b_[j];
+		}
+	}
+	assert(rows.size() == elements);
+	// the substances of the elements with b = 0 can not exist
+	is_active.assign(N, 0);
+	for(size_t k = 0; k != N; ++k) {
+		bool is_possible = ub[k] > 0;
+		for(size_t j = 0; j != M && is_possible; ++j) {
+			is_possible = b_[j] > 0 || a[j * N + k] == 0;
+		}
+		is_active[k] = is_possible;
+	}
+	// the start is feasible: all potentials are equal and each constraint
+	// is less than -1
+	bool has_species = false;
+	double start = 0;
+	for(size_t k = 0; k != N; ++k) {
+		if(!is_active[k]) {
+			continue;
+		}
+		double atoms = 0;
+		for(const auto j : rows) {
+			atoms += a[j * N + k];
+		}
+		if(atoms <= 0) {
+			return false;
+		}
+		const double count = k < begin[1] ? begin[1] - begin[0] :
+							 k < begin[2] ? begin[2] - begin[1] : 1;
+		const double value = (c[k] - std::log(count) - 1) / atoms;
+		start = has_species ? std::min(start, value) : value;
+		has_species = true;
+	}
+	if(!has_species) {
+		return false;
+	}
+	std::vector<double> pi(elements, start);
+	double minf;
+	try {
+		opt.optimize(pi, minf);
+	}
+	catch(std::exception&) {
+		return false;
+	}
+	// the individuals are tried first, so the degenerate dual of
+	// the stoichiometric individuals gives no traces of the mixtures
+	std::vector<size_t> phases;
+	std::vector<double> moles;
+	if(!Recover(pi, false, phases, moles) && !Recover(pi, true, phases, moles)) {
+		return false;
+	}
+	Polish(pi, phases, moles);
+	std::fill(amounts.begin(), amounts.end(), 0.0);
+	for(size_t q = 0, size = phases.size(); q != size; ++q) {
+		const auto phase = phases[q];
+		if(phase < N) {
+			amounts[phase] = std::min(moles[q], ub[phase]);
+			continue;
+		}
+		const auto p = phase - N;
+		const double ln_stability = LnStability(pi.data(), p, nullptr);
+		for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+			if(is_active[k]) {
+				amounts[k] = std::min(moles[q] *
+						std::exp(Potential(pi.data(), k) - c[k] - ln_stability), ub[k]);
+			}
+		}
+	}
+	return true;
+}
+
+bool DualSolver::IsDominated(const size_t k) const
+{
+	// an individual of the same composition, e.g. another modification,
+	// has the less G
+	for(size_t other = begin[mixtures]; other != N; ++other) {
+		if(other == k || !is_active[other]) {
+			continue;
+		}
+		const double ratio = CompositionRatio(a, M, N, k, other);
+		if(ratio > 0 && ratio * c[other] < c[k]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void DualSolver::Columns(const std::vector<double>& pi,
+						 const std::vector<size_t>& phases,
+						 std::vector<double>& columns) const
+{
+	// the mixture column is its composition at pi
+	columns.clear();
+	for(const auto phase : phases) {
+		if(phase < N) {
+			for(const auto j : rows) {
+				columns.push_back(a[j * N + phase]);
+			}
+			continue;
+		}
+		const auto p = phase - N;
+		const double ln_stability = LnStability(pi.data(), p, nullptr);
+		for(const auto j : rows) {
+			double sum = 0;
+			for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+				if(is_active[k]) {
+					sum += a[j * N + k] *
+							std::exp(Potential(pi.data(), k) - c[k] - ln_stability);
+				}
+			}
+			columns.push_back(sum);
+		}
+	}
+}
+
+bool DualSolver::Recover(const std::vector<double>& pi, const bool with_mixtures,
+						 std::vector<size_t>& phases, std::vector<double>& moles) const
+{
+	// the moles of the phases with the active constraints by the balance
+	phases.clear();
+	for(size_t p = 0; p != mixtures && with_mixtures; ++p) {
+		if(begin[p] != begin[p + 1] &&
+				LnStability(pi.data(), p, nullptr) >= -epsilon_active) {
+			phases.push_back(N + p);
+		}
+	}
+	for(size_t k = begin[mixtures]; k != N; ++k) {
+		if(is_active[k] && Potential(pi.data(), k) - c[k] >= -epsilon_active &&
+				!IsDominated(k)) {
+			phases.push_back(k);
+		}
+	}
+	std::vector<double> columns;
+	Columns(pi, phases, columns);
+	if(!NonNegativeLeastSquares(columns, b, elements, phases.size(), moles)) {
+		return false;
+	}
+	std::vector<double> balance(b);
+	for(size_t q = 0, size = phases.size(); q != size; ++q) {
+		for(size_t r = 0; r != elements; ++r) {
+			balance[r] -= columns[q * elements + r] * moles[q];
+		}
+	}
+	for(const auto value : balance) {
+		if(std::abs(value) > Optimization::epsilon_accuracy * scale) {
+			return false;
+		}
+	}
+	// the phases of zero moles are not needed
+	size_t size = 0;
+	for(size_t q = 0; q != phases.size(); ++q) {
+		if(moles[q] > 0) {
+			phases[size] = phases[q];
+			moles[size] = moles[q];
+			++size;
+		}
+	}
+	phases.resize(size);
+	moles.resize(size);
+	return true;
+}
+
+void DualSolver::Polish(std::vector<double>& pi, const std::vector<size_t>& phases,
+						std::vector<double>& moles) const
+{
+	// Newton's steps in pi and the moles for the active constraints and
+	// the balance, the step of SLSQP is not accurate enough for the traces.
+	// The result of the recovery is kept if the system is singular or
+	// a phase becomes negative
+	constexpr int max_iterations = 10;
+	const size_t P = phases.size();
+	const size_t S = elements + P;
+	std::vector<double> pi_new, moles_new, columns, matrix, x;
+	for(int i = 0; i != max_iterations; ++i) {
+		Columns(pi, phases, columns);
+		matrix.assign(S * S, 0.0);
+		x.assign(S, 0.0);
+		for(size_t r = 0; r != elements; ++r) {
+			x[r] = b[r];
+		}
+		for(size_t q = 0; q != P; ++q) {
+			const double* column = columns.data() + q * elements;
+			const auto phase = phases[q];
+			for(size_t r = 0; r != elements; ++r) {
+				matrix[r * S + elements + q] = column[r];
+				matrix[(elements + q) * S + r] = column[r];
+				x[r] -= column[r] * moles[q];
+			}
+			if(phase < N) {
+				x[elements + q] = c[phase] - Potential(pi.data(), phase);
+				continue;
+			}
+			// d(N x_k)/d pi = N x_k (a_k - composition)
+			const auto p = phase - N;
+			const double ln_stability = LnStability(pi.data(), p, nullptr);
+			x[elements + q] = -ln_stability;
+			for(size_t k = begin[p]; k != begin[p + 1]; ++k) {
+				if(!is_active[k]) {
+					continue;
+				}
+				const double w = moles[q] *
+						std::exp(Potential(pi.data(), k) - c[k] - ln_stability);
+				for(size_t r = 0; r != elements; ++r) {
+					const double a_r = a[rows[r] * N + k];
+					if(a_r == 0) {
+						continue;
+					}
+					for(size_t l = 0; l != elements; ++l) {
+						matrix[r * S + l] += w * a_r * (a[rows[l] * N + k] - column[l]);
+					}
+				}
+			}
+		}
+		// pi is not defined by the traces or the stoichiometric individuals,
+		// then the regularization keeps it
+		double norm = 0;
+		for(size_t r = 0; r != elements; ++r) {
+			norm = std::max(norm, std::abs(matrix[r * S + r]));
+		}
+		for(size_t r = 0; r != elements; ++r) {
+			matrix[r * S + r] += epsilon_regularization * std::max(norm, 1.0);
+		}
+		if(!SolveLinearSystem(matrix, x, S)) {
+			return;
+		}
+		pi_new = pi;
+		moles_new = moles;
+		double step = 0;
+		for(size_t r = 0; r != elements; ++r) {
+			pi_new[r] += x[r];
+			step = std::max(step, std::abs(x[r]));
+		}
+		for(size_t q = 0; q != P; ++q) {
+			moles_new[q] += x[elements + q];
+			if(moles_new[q] < 0) {
+				return;
+			}
+		}
+		pi.swap(pi_new);
+		moles.swap(moles_new);
+		if(step <= epsilon_pi) {
+			return;
+		}
+	}
+}
+
+static DualSolver& GetDualSolver(const size_t elements, const size_t constraints)
+{
+	constexpr size_t max_solvers = 4;
+	static thread_local std::vector<std::unique_ptr<DualSolver>> solvers;
+	auto it = std::find_if(solvers.begin(), solvers.end(),
+						   [=](const std::unique_ptr<DualSolver>& solver){
+		return solver->elements == elements && solver->constraints == constraints;
+	});
+	if(it != solvers.end()) {
+		return **it;
+	}
+	if(solvers.size() == max_solvers) {
+		solvers.erase(solvers.begin());
+	}
+	solvers.push_back(std::make_unique<DualSolver>(elements, constraints));
+	return *solvers.back();
 }
 
-void OptimizationItem::DefineOrderOfSubstances()
+bool OptimizationItem::MinimizeByDual()
 {
-	std::set<int> gas, liq, ind;
-	for(const auto& [id, sub_temp_range] : temp_ranges) {
-		auto&& tr = Thermodynamics::FindCoef(temperature_K_current, sub_temp_range);
-		if(tr.phase == QStringLiteral("G")) {
-			gas.insert(id);
-		} else if(tr.phase == QStringLiteral("L")) {
-			switch(parameters.liquid_solution) {
-			case ParametersNS::LiquidSolution::No:
-				ind.insert(id);
-				break;
-			case ParametersNS::LiquidSolution::One:
-				liq.insert(id);
-				break;
-			}
-		} else { // trange->phase == QStringLiteral("S")
-			ind.insert(id);
-		}
+	const size_t elements = static_cast<size_t>(
+				std::count_if(b.cbegin(), b.cend(), [](const double b_j){ return b_j > 0; }));
+	if(elements == 0) {
+		std::fill(n.begin(), n.end(), 0.0);
+		result_of_optimization = 0;
+		return true;
 	}
-	number.gases = gas.size();
-	number.liquids = liq.size();
-	number.individuals = ind.size();
-	assert(number.gases + number.liquids + number.individuals ==
-		   number.substances);
-	substances_id_order.clear();
-	auto back_ins = std::back_inserter(substances_id_order);
-	std::copy(gas.cbegin(), gas.cend(), back_ins);
-	std::copy(liq.cbegin(), liq.cend(), back_ins);
-	std::copy(ind.cbegin(), ind.cend(), back_ins);
+	const size_t constraints = DualSolver::mixtures + number.substances -
+			ordering->gases - ordering->liquids;
+	auto&& solver = GetDualSolver(elements, constraints);
+	if(!solver.Solve(*ordering, b, c, ub, n)) {
+		return false;
+	}
+	const OptimizationItem* self = this;
+	std::vector<double> grad;
+	result_of_optimization = context->kernels->objective(n, grad, &self);
+	return true;
 }
 
-void OptimizationItem::MakeConstraintsMatrixA()
+void SimplexSolver::Pivot(const size_t row, const size_t column)
 {
-	// It depends on order of substances
-	// size = N * M
-	size_t j = 0;
-	for(auto&& element_id : elements) {
-		auto&& a_j = constraints.at(j++).a_j;
-		size_t i = 0;
-		for(auto&& substance_id : substances_id_order) {
-			const auto& sub = subs_element_composition.at(substance_id);
-			auto element_it = sub.find(element_id);
-			a_j.at(i++) = (element_it == sub.cend()) ? 0.0 : element_it->second;
+	double* row_p = tableau.data() + row * width;
+	const double pivot = row_p[column];
+	for(size_t k = 0; k != width; ++k) {
+		row_p[k] /= pivot;
+	}
+	for(size_t i = 0; i != M + 1; ++i) {
+		double* row_i = tableau.data() + i * width;
+		const double factor = row_i[column];
+		if(i == row || factor == 0) {
+			continue;
 		}
+		for(size_t k = 0; k != width; ++k) {
+			row_i[k] -= factor * row_p[k];
+		}
+		row_i[column] = 0;
 	}
+	basis[row] = column;
 }
 
-void OptimizationItem::MakeConstraintsB()
+void SimplexSolver::Shift(const size_t column, const double value)
 {
-	std::unordered_map<int, double> el_id_amount;
-	for(const auto& [sub_id, el_cmp] : subs_element_composition) {
-		auto sub_mol = amounts.at(sub_id).sum_mol;
-		for(const auto& [el_id, el_value] : el_cmp) {
-			el_id_amount[el_id] += sub_mol * el_value;
-		}
+	// the nonbasic column moves by value, the basic ones keep A x = b
+	const size_t rhs = width - 1;
+	for(size_t i = 0; i != M + 1; ++i) {
+		At(i, rhs) -= At(i, column) * value;
 	}
-	size_t el_id;
-	for(size_t j = 0; j != number.elements; ++j) {
-		el_id = elements.at(j);
-		constraints.at(j).b_j = el_id_amount.at(el_id);
+}
+
+void SimplexSolver::Enter(const size_t row, const size_t column)
+{
+	if(is_upper[column]) {
+		Shift(column, -bound[column]);
+		is_upper[column] = 0;
 	}
+	Pivot(row, column);
 }
 
-void OptimizationItem::MakeC()
+bool SimplexSolver::Iterate(const double epsilon)
 {
-	// depends on substances_id_order
-	switch(parameters.minimization_function) {
-	case ParametersNS::MinimizationFunction::GibbsEnergy:
-		switch(parameters.database) {
-		case ParametersNS::Database::Thermo:
-			std::transform(substances_id_order.cbegin(), substances_id_order.cend(),
-						   c.begin(), [this](const int id){
-				return Thermodynamics::Thermo::TF_c(temperature_K_current,
-													temp_ranges.at(id));});
-			break;
-		case ParametersNS::Database::HSC:
-			std::transform(substances_id_order.cbegin(), substances_id_order.cend(),
-						   c.begin(), [this](const int id){
-				return Thermodynamics::HSC::TF_c(temperature_K_current,
-												 temp_ranges.at(id));});
-			break;
+	const size_t rhs = width - 1;
+	const size_t max_iterations = 50 * (M + N) + 100;
+	std::vector<char> is_basic(width, 0);
+	for(const auto k : basis) {
+		is_basic[k] = 1;
+	}
+	for(size_t iteration = 0; iteration != max_iterations; ++iteration) {
+		// the nonbasic column at zero with the negative reduced cost or
+		// at its upper bound with the positive one
+		size_t column = rhs;
+		for(size_t k = 0; k != rhs; ++k) {
+			if(is_allowed[k] && !is_basic[k] &&
+					(is_upper[k] ? At(M, k) > epsilon : At(M, k) < -epsilon)) {
+				column = k;
+				break;
+			}
 		}
-		break;
-	case ParametersNS::MinimizationFunction::Entropy:
-		// TODO Replace thermodynamic functions with correct ones
-		// TF_S_J is not correct
-		switch(parameters.database) {
-		case ParametersNS::Database::Thermo:
-			std::transform(substances_id_order.cbegin(), substances_id_order.cend(),
-						   c.begin(), [this](const int id){
-				return Thermodynamics::Thermo::TF_S_J(temperature_K_current,
-													  temp_ranges.at(id));});
-			break;
-		case ParametersNS::Database::HSC:
-			std::transform(substances_id_order.cbegin(), substances_id_order.cend(),
-						   c.begin(), [this](const int id){
-				return Thermodynamics::HSC::TF_S_J(temperature_K_current,
-												   temp_ranges.at(id));});
-			break;
+		if(column == rhs) {
+			return true;
+		}
+		// the step of the column is limited by its own bound, by the basic
+		// variables which fall to zero or rise to their bounds
+		const double direction = is_upper[column] ? -1.0 : 1.0;
+		size_t row = M;
+		bool is_leaving_upper = false;
+		bool is_limited = has_bound[column];
+		double step = bound[column];
+		for(size_t i = 0; i != M; ++i) {
+			const double a_ik = direction * At(i, column);
+			double r;
+			if(a_ik > epsilon_pivot) {
+				r = std::max(At(i, rhs), 0.0) / a_ik;
+			} else if(a_ik < -epsilon_pivot && has_bound[basis[i]]) {
+				r = std::max(bound[basis[i]] - At(i, rhs), 0.0) / -a_ik;
+			} else {
+				continue;
+			}
+			if(!is_limited || r < step ||
+					(row != M && r == step && basis[i] < basis[row])) {
+				row = i;
+				step = r;
+				is_limited = true;
+				is_leaving_upper = a_ik < 0;
+			}
+		}
+		if(row == M) {
+			if(!is_limited) {
+				return false;	// unbounded
+			}
+			// to the other bound without the change of the basis
+			Shift(column, direction * bound[column]);
+			is_upper[column] = !is_upper[column];
+			continue;
+		}
+		const size_t leaving = basis[row];
+		Enter(row, column);
+		is_basic[leaving] = 0;
+		is_basic[column] = 1;
+		if(is_leaving_upper) {
+			Shift(leaving, bound[leaving]);
+			is_upper[leaving] = 1;
 		}
-		break;
 	}
+	return false;
 }
 
-void OptimizationItem::MakeUB()
+bool SimplexSolver::Solve(const double* a, const size_t M_, const size_t N_,
+						  const std::vector<double>& b, const std::vector<double>& cost,
+						  const std::vector<double>& ub, std::vector<double>& x)
 {
-	// depends on constraints
-	std::fill(ub.begin(), ub.end(), std::numeric_limits<double>::max());
-	for(const auto& constraint : constraints) {
-		std::transform(constraint.a_j.cbegin(), constraint.a_j.cend(),
-					   ub.cbegin(), ub.begin(),
-					   [bj = constraint.b_j](auto aji, auto ubi){
-			if(aji > 0) {
-				auto tmp = bj / aji;
-				return tmp < ubi ? tmp : ubi;
-			} else {
-				return ubi;
+	M = M_;
+	N = N_;
+	width = N + M + 1;
+	const size_t rhs = width - 1;
+	scale = 0;
+	for(size_t i = 0; i != M; ++i) {
+		scale = std::max(scale, std::abs(b[i]));
+	}
+	if(scale == 0) {
+		scale = 1;
+	}
+
+	// phase 1, the artificial variables make the start basis
+	tableau.assign((M + 1) * width, 0.0);
+	basis.resize(M);
+	is_allowed.assign(N + M, 0);
+	is_upper.assign(N + M, 0);
+	has_bound.assign(N + M, 0);
+	bound.assign(N + M, 0.0);
+	for(size_t k = 0; k != N; ++k) {
+		is_allowed[k] = ub[k] > 0;
+		if(ub[k] < std::numeric_limits<double>::max()) {
+			has_bound[k] = 1;
+			bound[k] = ub[k] / scale;
+		}
+	}
+	for(size_t i = 0; i != M; ++i) {
+		const double sign = b[i] < 0 ? -1.0 : 1.0;
+		for(size_t k = 0; k != N; ++k) {
+			if(is_allowed[k]) {
+				At(i, k) = sign * a[i * N + k];
 			}
-		});
+		}
+		At(i, N + i) = 1;
+		At(i, rhs) = sign * b[i] / scale;
+		basis[i] = N + i;
+		for(size_t k = 0; k != N; ++k) {
+			At(M, k) -= At(i, k);
+		}
+		At(M, rhs) -= At(i, rhs);
+	}
+	if(!Iterate(epsilon_cost) || -At(M, rhs) > epsilon_feasibility) {
+		return false;
+	}
+	// the artificial variables left at zero are replaced, the rows
+	// without other columns are redundant
+	for(size_t i = 0; i != M; ++i) {
+		if(basis[i] < N) {
+			continue;
+		}
+		for(size_t k = 0; k != N; ++k) {
+			if(is_allowed[k] && std::abs(At(i, k)) > epsilon_pivot &&
+					std::find(basis.cbegin(), basis.cend(), k) == basis.cend()) {
+				Enter(i, k);
+				break;
+			}
+		}
 	}
 
-	// check for extrapolation and zeroize if it not exist
-	switch(parameters.extrapolation) {
-	case ParametersNS::Extrapolation::Disable:
-		std::transform(substances_id_order.cbegin(), substances_id_order.cend(),
-					   ub.cbegin(), ub.begin(),
-					   [this](const int sub_id, const double ubi){
-			return IsExistAtCurrentTemperature(sub_id) ? ubi : 0.0;
-		});
-		break;
-	case ParametersNS::Extrapolation::Enable:
-		break;
+	// phase 2
+	double norm = 0;
+	for(size_t k = 0; k != N; ++k) {
+		At(M, k) = is_allowed[k] ? cost[k] : 0.0;
+		norm = std::max(norm, std::abs(At(M, k)));
+	}
+	std::fill(tableau.begin() + static_cast<std::ptrdiff_t>(M * width + N),
+			  tableau.end(), 0.0);
+	for(size_t i = 0; i != M; ++i) {
+		const double c_i = basis[i] < N ? cost[basis[i]] : 0.0;
+		if(c_i == 0) {
+			continue;
+		}
+		for(size_t k = 0; k != width; ++k) {
+			At(M, k) -= c_i * At(i, k);
+		}
+	}
+	if(!Iterate(epsilon_cost * (1 + norm))) {
+		return false;
+	}
+	std::fill_n(x.begin(), N, 0.0);
+	for(size_t k = 0; k != N; ++k) {
+		if(is_upper[k]) {
+			x[k] = ub[k];
+		}
+	}
+	for(size_t i = 0; i != M; ++i) {
+		if(basis[i] < N) {
+			x[basis[i]] = std::clamp(At(i, rhs) * scale, 0.0, ub[basis[i]]);
+		}
 	}
+	return true;
 }
 
-void OptimizationItem::MakeN()
+// Moves the solution of Solve() into the interior: the nonbasic variables
+// of the first columns at zero become delta and the basic ones keep
+// A x = b, they are clamped if they are degenerate
+void SimplexSolver::Interior(const double delta, const size_t mixtures,
+							 const std::vector<double>& ub, std::vector<double>& x)
 {
-	std::transform(ub.cbegin(), ub.cend(), n.begin(), [](double n){
-		return n / 2;
-	});
+	const size_t rhs = width - 1;
+	std::vector<char> is_basic(N, 0);
+	for(size_t i = 0; i != M; ++i) {
+		if(basis[i] < N) {
+			is_basic[basis[i]] = 1;
+		}
+	}
+	const auto IsMoved = [&](const size_t k){
+		return is_allowed[k] && !is_basic[k] && !is_upper[k]; };
+	for(size_t k = 0; k != mixtures; ++k) {
+		if(IsMoved(k)) {
+			x[k] = std::min(delta, ub[k] / 2);
+		}
+	}
+	for(size_t i = 0; i != M; ++i) {
+		const size_t k_i = basis[i];
+		if(k_i >= N) {
+			continue;
+		}
+		double x_i = At(i, rhs) * scale;
+		for(size_t k = 0; k != mixtures; ++k) {
+			if(IsMoved(k)) {
+				x_i -= At(i, k) * x[k];
+			}
+		}
+		x[k_i] = std::clamp(x_i, k_i < mixtures ? std::min(delta, ub[k_i] / 2) : 0.0,
+							ub[k_i]);
+	}
 }
 
-void OptimizationItem::Equilibrium()
+static thread_local SimplexSolver simplex_solver;
+
+// Gives the item n, c, ub and b of a part of the problem with its A,
+// numbers and the moles of the rest in the mixtures, the destructor gives
+// the item its own back even if nlopt throws
+class PartOfProblem final
 {
-	DefineOrderOfSubstances();
-	MakeConstraintsMatrixA();
-	MakeUB(); // extrapolation is taken into account here
-	MakeC(); // depends on current temperature
-	MakeN(); // set to half of ub
+	OptimizationItem& item;
+	std::vector<double>& n;
+	std::vector<double>& c;
+	std::vector<double>& ub;
+	std::vector<double>& b;
+	const Numbers full;
+public:
+	PartOfProblem(OptimizationItem& item_, std::vector<double>& n_,
+				  std::vector<double>& c_, std::vector<double>& ub_,
+				  std::vector<double>& b_, const std::vector<double>& a,
+				  const Numbers& numbers, const double gas_other = 0,
+				  const double liquid_other = 0)
+		: item{item_}, n{n_}, c{c_}, ub{ub_}, b{b_}, full{item_.number}
+	{
+		std::swap(item.n, n);
+		std::swap(item.c, c);
+		std::swap(item.ub, ub);
+		std::swap(item.b, b);
+		item.active_a = &a;
+		item.number = numbers;
+		item.gas_of_other_blocks = gas_other;
+		item.liquid_of_other_blocks = liquid_other;
+	}
+	~PartOfProblem()
+	{
+		std::swap(item.n, n);
+		std::swap(item.c, c);
+		std::swap(item.ub, ub);
+		std::swap(item.b, b);
+		item.active_a = nullptr;
+		item.number = full;
+		item.gas_of_other_blocks = 0;
+		item.liquid_of_other_blocks = 0;
+	}
+	PartOfProblem(const PartOfProblem&) = delete;
+	PartOfProblem& operator=(const PartOfProblem&) = delete;
+};
 
-	nlopt::result result;
-	result_of_optimization = Minimize(nlopt::LD_SLSQP, result);
-	if(result == nlopt::XTOL_REACHED) return;
-	result_of_optimization = Minimize(nlopt::LD_AUGLAG_EQ, result);
-	if(result == nlopt::XTOL_REACHED) return;
-	result_of_optimization = Minimize(nlopt::LD_SLSQP, result);
+bool OptimizationItem::MinimizeLinear()
+{
+	// the objective is linear if the gas and the liquid solution
+	// are absent, e.g. by the extrapolation at the current temperature
+	const auto mixtures = static_cast<std::ptrdiff_t>(number.gases + number.liquids);
+	if(!std::all_of(ub.cbegin(), ub.cbegin() + mixtures,
+					[](const double ub_k){ return ub_k == 0; })) {
+		return false;
+	}
+	// the cost of the individuals is c with the sign of the objective,
+	// n is not made yet
+	const double sign = context->kernels->sign;
+	std::vector<double> cost(number.substances, 0.0);
+	std::transform(c.cbegin() + mixtures, c.cend(), cost.begin() + mixtures,
+				   [sign](const double c_k){ return sign * c_k; });
+	if(!simplex_solver.Solve(ordering->a.data(), number.elements,
+							 number.substances, b, cost, ub, n)) {
+		return false;
+	}
+	const OptimizationItem* self = this;
+	std::vector<double> grad;
+	result_of_optimization = context->kernels->objective(n, grad, &self);
+	return true;
 }
 
-void OptimizationItem::Equilibrium(const double temperature_K)
+// The gradient of the objective at n = ub / 2, the mixtures get
+// c_k + ln(x_k) of the phase and the individuals c_k
+void OptimizationItem::MakeLinearCost(std::vector<double>& cost) const
 {
-	temperature_K_current = temperature_K;
-	Equilibrium();
+	const double sign = context->kernels->sign;
+	cost.resize(number.substances);
+	const auto Phase = [&](const size_t first, const size_t count){
+		const double sum = std::accumulate(ub.cbegin() + static_cast<std::ptrdiff_t>(first),
+				ub.cbegin() + static_cast<std::ptrdiff_t>(first + count), 0.0) / 2;
+		const double ls = Log_eps(sum);
+		for(size_t k = first; k != first + count; ++k) {
+			cost[k] = sign * (c[k] + Log_eps(ub[k] / 2) - ls);
+		}
+	};
+	Phase(0, number.gases);
+	Phase(number.gases, number.liquids);
+	for(size_t k = number.gases + number.liquids; k != number.substances; ++k) {
+		cost[k] = sign * c[k];
+	}
 }
 
-void OptimizationItem::AdiabaticTemperature()
+void OptimizationItem::MakeLinearEstimate()
 {
-	double T_min = 298.15;
-	double T_max = 10000;
-	double T_cur;
-	Equilibrium(T_min);
-	H_current = H_kJ_Current();
-	if(H_initial < H_current) {
-		return;
-	}
-	Equilibrium(T_max);
-	H_current = H_kJ_Current();
-	if(H_initial > H_current) {
+	// the objective is linearized at n = ub / 2, the vertex is moved
+	// into the interior for the logarithms of the mixtures
+	constexpr double relative_delta = 1.0E-4;
+	std::vector<double> cost;
+	MakeLinearCost(cost);
+	if(!simplex_solver.Solve(ordering->a.data(), number.elements,
+							 number.substances, b, cost, ub, n)) {
+		std::transform(ub.cbegin(), ub.cend(), n.begin(), [](const double ub_k){
+			return ub_k / 2;
+		});
 		return;
 	}
-	T_cur = (T_min + T_max) / 2;
-	Equilibrium(T_cur);
-	H_current = H_kJ_Current();
-	double at_epsilon = std::pow(10, -parameters.at_accuracy)/2;
-#if !defined(NDEBUG) && defined(VERBOSE_DEBUG)
-	int n = 0;
-#endif
-	while((std::abs(T_max - T_min) > at_epsilon))
-	{
-		if(H_initial < H_current) {
-			T_max = T_cur;
-		} else {
-			T_min = T_cur;
-		}
-		T_cur = (T_min + T_max) / 2;
-		Equilibrium(T_cur);
-		H_current = H_kJ_Current();
+	const double delta = relative_delta * *std::max_element(b.cbegin(), b.cend());
+	simplex_solver.Interior(delta, number.gases + number.liquids, ub, n);
+}
 
-#if !defined(NDEBUG) && defined(VERBOSE_DEBUG)
-		qDebug() << Qt::fixed << qSetRealNumberPrecision(10) << ++n
-				 << "H_current:" << H_current << "\tT_cur" << T_cur
-				 << "\tdelta_H:" << std::abs(H_current - H_initial)
-				 << "\tdelta_T:" << std::abs(T_max - T_min);
-#endif
+// The derivatives of the objective at the equilibrium are a_k pi for
+// the present species, pi is found by the least squares over them.
+// The small amounts of the mixtures are skipped, Log_eps distorts them.
+// False if the present species do not determine pi, e.g. TiB2 alone
+// for Ti and B.
+static bool ElementPotentialsOfSolution(const std::vector<double>& a, const size_t M,
+										const size_t N, const size_t mixtures,
+										const std::vector<double>& n,
+										const std::vector<double>& grad,
+										const double threshold,
+										std::vector<double>& pi)
+{
+	std::vector<double> normal(M * M, 0.0);
+	std::fill(pi.begin(), pi.end(), 0.0);
+	for(size_t k = 0; k != N; ++k) {
+		if(!(n[k] > (k < mixtures ? threshold : 0.0))) {
+			continue;
+		}
+		for(size_t i = 0; i != M; ++i) {
+			const double a_ik = a[i * N + k];
+			if(a_ik == 0) {
+				continue;
+			}
+			pi[i] += a_ik * grad[k];
+			for(size_t j = 0; j != M; ++j) {
+				normal[i * M + j] += a_ik * a[j * N + k];
+			}
+		}
 	}
+	return SolveLinearSystem(normal, pi, M);
 }
 
-void OptimizationItem::H_kJ_Initial()
+bool OptimizationItem::MinimizeByActiveSet()
 {
-	auto H = [this](const int id){
-		switch(parameters.database) {
-		case ParametersNS::Database::Thermo:
-			return Thermodynamics::Thermo::TF_H_kJ(temperature_K_initial,
-												   temp_ranges.at(id));
-		case ParametersNS::Database::HSC:
-			return Thermodynamics::HSC::TF_H_kJ(temperature_K_initial,
-												temp_ranges.at(id));
-		default:
-			throw std::logic_error("default in switch");
+	// nlopt gets the mixtures and the active individuals only. The element
+	// potentials of its solution give the driving force c_k - a_k pi of
+	// the individuals: the inactive ones with the negative force are added,
+	// the absent ones with the positive force are dropped, until the added
+	// set is empty. The first active set is the vertex of the linearized
+	// problem and the present substances of the start point.
+	constexpr int max_iterations = 10;
+	constexpr double epsilon_force = 1.0E-5;
+	constexpr double relative_threshold = 1.0E-3;
+	const Numbers full = number;
+	const size_t N = full.substances;
+	const size_t M = full.elements;
+	const size_t mixtures = full.gases + full.liquids;
+	std::vector<double> grad;
+	MakeLinearCost(grad);
+	std::vector<double> vertex(N);
+	if(!simplex_solver.Solve(ordering->a.data(), M, N, b, grad, ub, vertex)) {
+		return false;
+	}
+	const OptimizationItem* self = this;
+	std::vector<char> is_active(N, 0);
+	for(size_t k = mixtures; k != N; ++k) {
+		is_active[k] = ub[k] > 0 && (vertex[k] > 0 || (start_point && n[k] > 0));
+	}
+
+	const double threshold = relative_threshold * *std::max_element(b.cbegin(), b.cend());
+	std::vector<size_t> columns;
+	std::vector<double> n_active, c_active, ub_active, a_active, b_active;
+	std::vector<double> pi(M);
+	for(int iteration = 0; iteration != max_iterations; ++iteration) {
+		columns.clear();
+		for(size_t k = 0; k != N; ++k) {
+			if(k < mixtures || is_active[k]) {
+				columns.push_back(k);
+			}
+		}
+		const size_t R = columns.size();
+		n_active.resize(R);
+		c_active.resize(R);
+		ub_active.resize(R);
+		a_active.resize(M * R);
+		for(size_t i = 0; i != R; ++i) {
+			n_active[i] = n[columns[i]];
+			c_active[i] = c[columns[i]];
+			ub_active[i] = ub[columns[i]];
+			for(size_t j = 0; j != M; ++j) {
+				a_active[j * R + i] = ordering->a[j * N + columns[i]];
+			}
+		}
+		b_active = b;
+		Numbers numbers = full;
+		numbers.substances = R;
+		numbers.individuals = R - mixtures;
+		{
+			PartOfProblem part(*this, n_active, c_active, ub_active, b_active,
+							   a_active, numbers);
+			MinimizeByNLopt();
+		}
+		std::fill(n.begin(), n.end(), 0.0);
+		for(size_t i = 0; i != R; ++i) {
+			n[columns[i]] = n_active[i];
 		}
-	};
 
-	switch(parameters.H_initial_by) {
-	case ParametersNS::H_Initial_By::AsChecked:
-		H_initial = std::accumulate(amounts.cbegin(), amounts.cend(), double{0.0},
-									[&H](double sum, decltype(amounts)::const_reference amount){
-			if(amount.second.sum_mol > 0.0) {
-				return sum + H(amount.first) * amount.second.sum_mol;
-			} else {
-				return sum;
+		// the tangent plane test
+		context->kernels->objective(n, grad, &self);
+		bool is_added = false;
+		if(!ElementPotentialsOfSolution(ordering->a, M, N, mixtures, n, grad,
+										threshold, pi)) {
+			// the forces are not unique, the vertex of the problem linearized
+			// at n gives the individuals which decrease the objective
+			if(!simplex_solver.Solve(ordering->a.data(), M, N, b, grad, ub, vertex)) {
+				return false;
 			}
-		});
-		break;
-	case ParametersNS::H_Initial_By::ByMinimumGibbsEnergy: {
-		auto G = [this](const int id){
-			switch(parameters.database) {
-			case ParametersNS::Database::Thermo:
-				return Thermodynamics::Thermo::TF_G_kJ(temperature_K_initial,
-													   temp_ranges.at(id));
-			case ParametersNS::Database::HSC:
-				return Thermodynamics::HSC::TF_G_kJ(temperature_K_initial,
-													temp_ranges.at(id));
-			default:
-				throw std::logic_error("default in switch");
-			}
-		};
-		double H_sum{0.0};
-		for(const auto& [sub_id, amount] : amounts) {
-			if(amount.sum_mol <= 0.0) continue;
-			double G_min = G(sub_id);
-			double G_tmp;
-			int sub_id_G_min = sub_id;
-			const auto& sub_cmp_cur = subs_element_composition.at(sub_id);
-			for(const auto& [sub_id_n, sub_cmp_n] :	subs_element_composition) {
-				if(sub_id_n == sub_id) continue;
-				if(sub_cmp_cur == sub_cmp_n) {
-					G_tmp = G(sub_id_n);
-					if(G_tmp < G_min) {
-						G_min = G_tmp;
-						sub_id_G_min = sub_id_n;
+			const double at_n = std::inner_product(grad.cbegin(), grad.cend(),
+												   n.cbegin(), 0.0);
+			const double at_vertex = std::inner_product(grad.cbegin(), grad.cend(),
+														vertex.cbegin(), 0.0);
+			if(at_vertex < at_n - epsilon_force * (1 + std::abs(at_n))) {
+				for(size_t k = mixtures; k != N; ++k) {
+					if(!is_active[k] && vertex[k] > 0) {
+						is_active[k] = 1;
+						is_added = true;
 					}
 				}
 			}
-			H_sum += H(sub_id_G_min) * amount.sum_mol;
+			if(!is_added) {
+				return true;
+			}
+			continue;
+		}
+		for(size_t k = mixtures; k != N; ++k) {
+			if(!(ub[k] > 0)) {
+				continue;
+			}
+			double force = grad[k];
+			for(size_t j = 0; j != M; ++j) {
+				force -= ordering->a[j * N + k] * pi[j];
+			}
+			const double epsilon = epsilon_force * (1 + std::abs(grad[k]));
+			if(!is_active[k] && force < -epsilon) {
+				is_active[k] = 1;
+				is_added = true;
+			} else if(is_active[k] && n[k] == 0 && force > epsilon) {
+				is_active[k] = 0;
+			}
+		}
+		if(!is_added) {
+			return true;	// result_of_optimization is of the active set
 		}
-		H_initial = H_sum;
-	}
-		break;
-	default:
-		throw std::logic_error("default in switch");
 	}
+	return false;
 }
 
-double OptimizationItem::H_kJ_Current()
+bool OptimizationItem::MinimizeByBlocks()
 {
-	return std::transform_reduce(n.cbegin(), n.cend(),
-								 substances_id_order.cbegin(), double{0.0},
-								 std::plus<>(),
-								 [this](const double ni, const int id){
-		switch(parameters.database) {
-		case ParametersNS::Database::Thermo:
-			return ni * Thermodynamics::Thermo::TF_H_kJ(temperature_K_current,
-														temp_ranges.at(id));
-		case ParametersNS::Database::HSC:
-			return ni * Thermodynamics::HSC::TF_H_kJ(temperature_K_current,
-													 temp_ranges.at(id));
-		default:
-			throw std::logic_error("default in switch");
+	// The blocks share no elements, only the gas and the liquid solution
+	// couple them. A block of one possible substance, e.g. an inert argon,
+	// has the amount fixed by its elements. A block without the mixtures
+	// has the linear objective and its vertex is found by the simplex method
+	// once. The blocks with the mixtures are minimized by nlopt together,
+	// the moles of the fixed blocks in the mixtures are constant there.
+	const size_t N = number.substances;
+	const size_t M = number.elements;
+	const size_t mixtures = number.gases + number.liquids;
+	const size_t blocks = context->blocks;
+	std::vector<size_t> possible(blocks, 0);
+	for(size_t k = 0; k != N; ++k) {
+		if(ub[k] > 0) {
+			++possible[context->substance_blocks[ordering->order[k]]];
 		}
-	});
-}
-
-bool OptimizationItem::IsExistAtCurrentTemperature(const int sub_id)
-{
-	auto&& temp_range = temp_ranges.at(sub_id);
-	auto min = temp_range.cbegin()->T_min;
-	auto max = temp_range.crbegin()->T_max;
-	if(min <= temperature_K_current && temperature_K_current <= max) {
-		return true;
-	} else {
+	}
+	std::vector<char> is_coupled(blocks, 0);
+	for(size_t k = 0; k != mixtures; ++k) {
+		const auto block = context->substance_blocks[ordering->order[k]];
+		is_coupled[block] = possible[block] != 1;
+	}
+	if(std::all_of(is_coupled.cbegin(), is_coupled.cend(),
+				   [](const char is){ return is != 0; })) {
 		return false;
 	}
+	// the coupled part is the last
+	std::vector<std::vector<size_t>> columns(blocks + 1), rows(blocks + 1);
+	for(size_t k = 0; k != N; ++k) {
+		const auto block = context->substance_blocks[ordering->order[k]];
+		columns[is_coupled[block] ? blocks : block].push_back(k);
+	}
+	for(size_t j = 0; j != M; ++j) {
+		const auto block = context->element_blocks[j];
+		rows[is_coupled[block] ? blocks : block].push_back(j);
+	}
+	const double sign = context->kernels->sign;
+	double gas_other = 0;
+	double liquid_other = 0;
+	std::vector<double> n_part, c_part, ub_part, a_part, b_part;
+	for(size_t block = 0; block != blocks + 1; ++block) {
+		const auto& cols = columns[block];
+		const auto& elems = rows[block];
+		const size_t R = cols.size();
+		if(R == 0) {
+			continue;
+		}
+		if(block != blocks && possible[block] == 1) {
+			for(const auto k : cols) {
+				n[k] = ub[k];
+				if(k < number.gases) {
+					gas_other += n[k];
+				} else if(k < mixtures) {
+					liquid_other += n[k];
+				}
+			}
+			// ub is the least of b_j / a_jk, other elements may remain
+			for(const auto j : elems) {
+				double sum = 0;
+				for(const auto k : cols) {
+					sum += ordering->a[j * N + k] * n[k];
+				}
+				if(std::abs(sum - b[j]) > epsilon_accuracy * (1 + b[j])) {
+					return false;
+				}
+			}
+			continue;
+		}
+		n_part.resize(R);
+		c_part.resize(R);
+		ub_part.resize(R);
+		a_part.resize(elems.size() * R);
+		b_part.resize(elems.size());
+		Numbers numbers;
+		numbers.elements = elems.size();
+		numbers.substances = R;
+		for(size_t i = 0; i != R; ++i) {
+			const size_t k = cols[i];
+			n_part[i] = n[k];
+			c_part[i] = c[k];
+			ub_part[i] = ub[k];
+			if(k < number.gases) {
+				++numbers.gases;
+			} else if(k < mixtures) {
+				++numbers.liquids;
+			} else {
+				++numbers.individuals;
+			}
+			for(size_t r = 0; r != elems.size(); ++r) {
+				a_part[r * R + i] = ordering->a[elems[r] * N + k];
+			}
+		}
+		for(size_t r = 0; r != elems.size(); ++r) {
+			b_part[r] = b[elems[r]];
+		}
+		if(block != blocks) {
+			std::transform(c_part.cbegin(), c_part.cend(), c_part.begin(),
+						   [sign](const double c_k){ return sign * c_k; });
+			if(!simplex_solver.Solve(a_part.data(), elems.size(), R, b_part,
+									 c_part, ub_part, n_part)) {
+				return false;
+			}
+		} else {
+			PartOfProblem part(*this, n_part, c_part, ub_part, b_part, a_part,
+							   numbers, gas_other, liquid_other);
+			MinimizeByNLopt();
+		}
+		for(size_t i = 0; i != R; ++i) {
+			n[cols[i]] = n_part[i];
+		}
+	}
+	const OptimizationItem* self = this;
+	std::vector<double> grad;
+	result_of_optimization = context->kernels->objective(n, grad, &self);
+	return true;
 }
 
 double OptimizationItem::Minimize(const nlopt::algorithm algorithm,
 								  nlopt::result& result)
 {
 	double minf;
-	nlopt::opt opt(algorithm, static_cast<unsigned>(number.substances));
-	opt.set_lower_bounds(0);
+	auto&& solver = GetSolver(algorithm, context->kernels->objective,
+							  number.substances, number.elements);
+	auto&& opt = solver.opt;
+	solver.item = this;
+	solver.jacobian = nullptr;
 	opt.set_upper_bounds(ub);
-	switch(parameters.minimization_function) {
-	case ParametersNS::MinimizationFunction::GibbsEnergy:
-		opt.set_min_objective(Optimization::ThermodinamicFunction, this);
-		break;
-	case ParametersNS::MinimizationFunction::Entropy:
-		opt.set_min_objective(Optimization::ThermodinamicFunctionMinus, this);
-		break;
-	}
-	for(size_t j = 0; j < number.elements; ++j) {
-		opt.add_equality_constraint(Optimization::ConstraintFunction,
-						&constraints[j], Optimization::epsilon_accuracy);
-	}
-	// Using ftol's results in a noisy graph.
-	/* bug in nlopt:
-	 * Class nlopt::opt has private struct nlopt_opt which has field
-	 * double *xtol_abs.
-	 * Nlopt library does not allocate memory for xtol_abs array by default.
-	 * When the NLOPT_LD_AUGLAG_EQ algorithm is used, the nlopt library creates
-	 * a local_opt instance of nlopt_opt struct for local optimization and uses
-	 * the memcpy function to copy some data from the primary opt to local_opt.
-	 * And memcpy try to copy from null pointer xtol_abs to another.
-	 * Since xtol_abs is not allocated in primary opt, the program crashes.
-	 * File optimize.c line 755 in function nlopt_optimize_ then
-	 * file option.c line 698 in function nlopt_set_xtol_abs.
-	 * Solution: use the set_xtol_abs function for the primary opt instance,
-	 * which will allocate the necessary memory.
-	 */
-	opt.set_xtol_abs(Optimization::epsilon_accuracy);
-	opt.set_xtol_rel(Optimization::epsilon_accuracy);
-	opt.set_maxtime(Optimization::maxtime_of_minimize);
 
 	try {
 		result = opt.optimize(n, minf);
@@ -679,123 +4153,50 @@ double OptimizationItem::Minimize(const nlopt::algorithm algorithm,
 
 void OptimizationItem::MakeAmountsOfEquilibrium()
 {
-	assert(std::is_sorted(weights.cbegin(), weights.cend(),
-						  [](const SubstanceWeight& lhs, const SubstanceWeight& rhs){
-			   return lhs.id < rhs.id; }));
-	struct EquilibriumComposition {
-		int id;
-		double mol;
-	};
-	std::vector<EquilibriumComposition> vec_ec{number.substances};
-	std::transform(substances_id_order.cbegin(), substances_id_order.cend(),
-				   n.cbegin(), vec_ec.begin(), [](auto&& sub_id, auto&& n_i){
-		return EquilibriumComposition{sub_id, n_i};});
-	std::sort(vec_ec.begin(), vec_ec.end(), [](auto&& lhs, auto&& rhs){
-		return lhs.id < rhs.id;
-	});
-	assert(vec_ec.size() == weights.size());
-	size_t i = 0;
-	for(auto&& weight : weights) {
-		auto [id, mol] = vec_ec.at(i++);
-		assert(id == weight.id);
-		auto w = weight.weight;
-		auto gram = mol * w;
-		amounts_of_equilibrium[id] = Amounts{mol, gram, 0.0, 0.0, mol, gram, 0.0, 0.0};
+	assert(ordering->order.size() == static_cast<size_t>(context->weights.size()));
+	for(size_t k = 0; k != number.substances; ++k) {
+		auto i = ordering->order[k];
+		auto&& weight = context->weights.at(i);
+		auto mol = n[k];
+		auto gram = mol * weight.weight;
+		amounts_of_equilibrium[weight.id] = Amounts{mol, gram, 0.0, 0.0, mol, gram, 0.0, 0.0};
 	}
 	sum_of_equilibrium = GetSumAndRecalculate(amounts_of_equilibrium);
 }
 
-Composition OptimizationItemsMaker::MakeNewAmount(const Composition& amounts,
-			const SubstanceWeights& weights, const double value)
+GroupScales OptimizationItemsMaker::MakeGroupScale(const double value)
 {
 	// Group 1 - main composition
 	// Group 2 - variable composition
-	Composition new_amount{amounts};
 	switch(parameters.composition_range_unit) {
-	case ParametersNS::CompositionUnit::AtomicPercent: {
+	case ParametersNS::CompositionUnit::AtomicPercent:
 		if(sum.group_1_mol > 0.0 && sum.group_2_mol > 0.0) {
 			auto new_sum_group2 = sum.sum_mol * value / 100;
 			auto new_sum_group1 = sum.sum_mol - new_sum_group2;
-			auto coef1 = new_sum_group1 / sum.group_1_mol;
-			auto coef2 = new_sum_group2 / sum.group_2_mol;
-			for(const auto& weight : weights) {
-				auto id = weight.id;
-				auto w = weight.weight;
-				auto&& new_amount_at = new_amount.at(id);
-				new_amount_at.group_1_mol *= coef1;
-				new_amount_at.group_1_gram = new_amount_at.group_1_mol * w;
-				new_amount_at.group_2_mol *= coef2;
-				new_amount_at.group_2_gram = new_amount_at.group_2_mol * w;
-				new_amount_at.sum_mol = new_amount_at.group_1_mol +
-						new_amount_at.group_2_mol;
-				new_amount_at.sum_gram = new_amount_at.group_1_gram +
-						new_amount_at.group_2_gram;
-			}
-			GetSumAndRecalculate(new_amount);
+			return GroupScales{new_sum_group1 / sum.group_1_mol,
+							   new_sum_group2 / sum.group_2_mol};
 		}
-	}
 		break;
-	case ParametersNS::CompositionUnit::WeightPercent: {
+	case ParametersNS::CompositionUnit::WeightPercent:
 		if(sum.group_1_gram > 0.0 && sum.group_2_gram > 0.0) {
 			auto new_sum_group2 = sum.sum_gram * value / 100;
 			auto new_sum_group1 = sum.sum_gram - new_sum_group2;
-			auto coef1 = new_sum_group1 / sum.group_1_gram;
-			auto coef2 = new_sum_group2 / sum.group_2_gram;
-			for(const auto& weight : weights) {
-				auto id = weight.id;
-				auto w = weight.weight;
-				auto&& new_amount_at = new_amount.at(id);
-				new_amount_at.group_1_gram *= coef1;
-				new_amount_at.group_1_mol = new_amount_at.group_1_gram / w;
-				new_amount_at.group_2_gram *= coef2;
-				new_amount_at.group_2_mol = new_amount_at.group_2_gram / w;
-				new_amount_at.sum_mol = new_amount_at.group_1_mol +
-						new_amount_at.group_2_mol;
-				new_amount_at.sum_gram = new_amount_at.group_1_gram +
-						new_amount_at.group_2_gram;
-			}
-			GetSumAndRecalculate(new_amount);
+			return GroupScales{new_sum_group1 / sum.group_1_gram,
+							   new_sum_group2 / sum.group_2_gram};
 		}
-	}
 		break;
-	case ParametersNS::CompositionUnit::Mol: {
+	case ParametersNS::CompositionUnit::Mol:
 		if(sum.group_2_mol > 0.0) {
-			auto coef = value / sum.group_2_mol;
-			for(const auto& weight : weights) {
-				auto id = weight.id;
-				auto w = weight.weight;
-				auto&& new_amount_at = new_amount.at(id);
-				new_amount_at.group_2_mol *= coef;
-				new_amount_at.group_2_gram = new_amount_at.group_2_mol * w;
-				new_amount_at.sum_mol = new_amount_at.group_1_mol +
-						new_amount_at.group_2_mol;
-				new_amount_at.sum_gram = new_amount_at.group_1_gram +
-						new_amount_at.group_2_gram;
-			}
-			GetSumAndRecalculate(new_amount);
+			return GroupScales{1.0, value / sum.group_2_mol};
 		}
-	}
 		break;
-	case ParametersNS::CompositionUnit::Gram: {
+	case ParametersNS::CompositionUnit::Gram:
 		if(sum.group_2_gram > 0.0) {
-			auto coef = value / sum.group_2_gram;
-			for(const auto& weight : weights) {
-				auto id = weight.id;
-				auto w = weight.weight;
-				auto&& new_amount_at = new_amount.at(id);
-				new_amount_at.group_2_gram *= coef;
-				new_amount_at.group_2_mol = new_amount_at.group_2_gram / w;
-				new_amount_at.sum_mol = new_amount_at.group_1_mol +
-						new_amount_at.group_2_mol;
-				new_amount_at.sum_gram = new_amount_at.group_1_gram +
-						new_amount_at.group_2_gram;
-			}
-			GetSumAndRecalculate(new_amount);
+			return GroupScales{1.0, value / sum.group_2_gram};
 		}
-	}
 		break;
 	}
-	return new_amount;
+	return GroupScales{};
 }
 
 } // namespace Optimization
@@ -23,7 +23,11 @@
 #include "database.h"
 #include "amountsmodel.h"
 #include "parameters.h"
+#include "thermodynamics.h"
 #include <nlopt.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
 
 /* Order of substunces in vector n, size = N
 |------gas------|---------liq-------|------ind------|
@@ -33,12 +37,6 @@
 
 namespace Optimization {
 
-struct Constraint
-{
-	std::vector<double> a_j;
-	double b_j{0};
-};
-
 struct Numbers
 {
 	size_t elements{0};		// M
@@ -48,22 +46,207 @@ struct Numbers
 	size_t liquids{0};		// part of N
 };
 
-struct OptimizationItem final
+// Equilibrium enthalpy H(T) of one composition on the adaptive temperature
+// mesh. The curve is shared by all items with the same composition
+// and is calculated once, by the first item that needs it.
+class EnthalpyCurve final
+{
+	std::once_flag flag;
+	std::vector<double> temperatures;	// K, ascending
+	std::vector<double> enthalpies;		// kJ
+	std::vector<double> slopes;			// kJ/K, monotone cubic interpolation
+	std::vector<std::pair<double, double>> transitions; // K, intervals of jumps
+public:
+	static constexpr double T_min = 298.15;
+	static constexpr double T_max = 10000;
+	struct Root
+	{
+		double T_lo{T_min};
+		double T_hi{T_max};
+		double T{T_min};
+	};
+	void Calculate(const std::function<double(const double)>& H);
+	// T_lo == T_hi when H is out of the curve
+	Root FindRoot(const double H) const;
+	// 0 if it is unknown, e.g. at phase transitions
+	double Slope(const double T) const;
+	auto Size() const { return temperatures.size(); }
+private:
+	void Make(const std::function<double(const double)>& H);
+	void Refine(const std::function<double(const double)>& H,
+				const double T_lo, const double H_lo,
+				const double T_hi, const double H_hi,
+				std::vector<std::pair<double, double>>& nodes);
+	void MakeSlopes();
+	double Hermite(const size_t k, const double t) const;
+};
+
+// Substances in the order |gas|liq|ind| and the A matrix in this order
+struct Ordering
+{
+	size_t gases{0};
+	size_t liquids{0};
+	size_t individuals{0};
+	std::vector<int> order;		// size = N, dense indices
+	std::vector<double> a;		// size = M * N, a_jk = [j * N + k]
+};
+
+// Temperatures between two neighbouring breakpoints, the temperature
+// ranges of all substances and so their phases are the same there
+struct TemperatureInterval
+{
+	size_t ordering{0};
+	std::vector<const TempRangeData*> coefs;	// size = N, in order
+	Thermodynamics::CoefficientsBlock block;	// coefs for the Thermo database
+};
+
+// Neighbouring intervals with the same ordering, the order of substances
+// does not change there
+struct Segment
+{
+	const TemperatureInterval* first{nullptr};
+	const TemperatureInterval* last{nullptr};
+	double T_min{0};	// K
+	double T_max{0};	// K
+};
+
+struct Kernels;
+struct ProblemContext;
+
+// Piecewise polynomials of c, H and Cp of all substances. The pieces lie
+// inside the temperature intervals and the ranges of substances, they are
+// bisected until the polynomials agree with the exact functions at the
+// check points with the relative error 10^-accuracy. A piece which
+// can not be approximated is calculated by the exact functions.
+// G, S and F are calculated from them, so all properties are of
+// the same temperature.
+class Surrogate final
+{
+	struct Piece
+	{
+		double T_min{0};
+		double T_max{0};
+		bool exact{false};
+		size_t offset{0};	// in coefficients
+	};
+	static constexpr size_t degree = 12;
+	size_t substances{0};
+	std::vector<double> starts;		// T_min of pieces, ascending
+	std::vector<Piece> pieces;
+	// [piece][function c, H, Cp][power][substance in order], then H_ref
+	// of F of the substances of the piece
+	std::vector<double> coefficients;
+	double T_max{0};
+public:
+	void Make(const ProblemContext& context, const double T_min_,
+			  const double T_max_, const int accuracy);
+	// false when T is out of the surrogate or in an exact piece
+	bool Evaluate(const double temperature_K,
+				  std::vector<double> Thermodynamics::PropertiesBlock::* c,
+				  Thermodynamics::PropertiesBlock& properties) const;
+	auto Size() const { return pieces.size(); }
+private:
+	void Evaluate(const Piece& piece, const double t,
+				  std::vector<double> Thermodynamics::PropertiesBlock::* c,
+				  Thermodynamics::PropertiesBlock& properties) const;
+	void Fit(const ProblemContext& context, const double T_min_,
+			 const double T_max_, const double tolerance, const size_t depth);
+};
+
+// Functions of all substances at one initial temperature, they are the same
+// for all items which start at it, e.g. for a row of a composition range.
+// The ordering and A are of the interval, they are shared by the context.
+struct TemperatureEntry
+{
+	std::once_flag flag;
+	const TemperatureInterval* interval{nullptr};
+	Thermodynamics::PropertiesBlock properties;			// size = N, in order
+	std::vector<Thermodynamics::Properties> substances;	// size = N
+};
+
+// Initial data which are the same for all items, read only
+struct ProblemContext final
 {
 	ParametersNS::Parameters parameters;
 	std::vector<int> elements;
 	SubstancesTempRangeData temp_ranges;
 	SubstancesElementComposition subs_element_composition;
 	SubstanceWeights weights;
-	Composition amounts;
+	Composition amounts;	// initial, groups are scaled in composition ranges
+	SubstanceWeights pruned;	// removed by Prescreen(), they cannot appear
+	// chosen by the database and the minimization function
+	const Kernels* kernels{nullptr};
+
+	// The system compiled to dense arrays for the solver. Substances are
+	// indexed in the order of weights (ascending id), elements in the order
+	// of elements.
+	std::vector<int> substance_ids;								// size = N
+	std::vector<const SubstanceTempRangeData*> substance_coefs;	// size = N
+	std::vector<double> element_matrix;	// size = M * N, a_ji = [j * N + i]
+	// the elements and the substances of the blocks which share no elements
+	size_t blocks{0};
+	std::vector<size_t> element_blocks;		// size = M
+	std::vector<size_t> substance_blocks;	// size = N
+	std::vector<double> breakpoints;				// K, ascending
+	std::vector<TemperatureInterval> intervals;		// K + 1
+	std::vector<Ordering> orderings;	// neighbouring intervals can share it
+	Surrogate surrogate;	// empty if it is disabled
+
+	ProblemContext(const ParametersNS::Parameters& parameters_,
+				   const std::vector<int>& elements_,
+				   const SubstancesTempRangeData& temp_ranges_,
+				   const SubstancesElementComposition& subs_element_composition_,
+				   const SubstanceWeights& weights_,
+				   const Composition& amounts_);
+	const TemperatureInterval& FindInterval(const double temperature_K) const;
+	// the hint and its neighbours are checked before the binary search
+	const TemperatureInterval& FindInterval(const double temperature_K,
+											const TemperatureInterval* hint) const;
+	// the intervals are merged only if extrapolation is enabled,
+	// otherwise the upper bounds of n can change at each breakpoint
+	Segment FindSegment(const double temperature_K) const;
+	// made once by the first item of the initial temperature, thread safe,
+	// other temperatures throw
+	const TemperatureEntry& AtTemperature(const double temperature_K) const;
+	size_t IndexOf(const int substance_id) const;
+private:
+	void MakeArrays();
+	bool Prescreen();
+	void MakeIntervals();
+	// the entries of the initial temperatures of the items, K, ascending
+	std::vector<double> initial_temperatures;
+	mutable std::vector<TemperatureEntry> entries;
+};
+
+// Scales of the groups of the initial amounts of the item
+struct GroupScales
+{
+	double group_1{1.0};
+	double group_2{1.0};
+};
+
+struct OptimizationItem final
+{
+	std::shared_ptr<const ProblemContext> context;
+	GroupScales scales;
 	Composition amounts_of_equilibrium;
 	Amounts sum_of_initial;
 	Amounts sum_of_equilibrium;
 
+	// buffers, they are allocated only during the calculation
 	std::vector<double> n, c;				// size = N, number_of_substances
+	Thermodynamics::PropertiesBlock properties;	// size = N
+	// properties of the current temperature, own or of the TemperatureEntry
+	const Thermodynamics::PropertiesBlock* current_properties{nullptr};
 	std::vector<double> ub;					// size = N, ub = upper_bounds
-	std::vector<Constraint> constraints;	// size = M, number_of_elements
-	std::vector<int> substances_id_order;	// size = N, in order
+	std::vector<double> b;					// size = M, number_of_elements
+	// of the current temperature
+	const TemperatureInterval* interval{nullptr};
+	const Ordering* ordering{nullptr};
+	const std::vector<double>* active_a{nullptr};	// A of the active set or the blocks
+	// moles of the fixed blocks in the mixtures, constant in the objective
+	double gas_of_other_blocks{0};
+	double liquid_of_other_blocks{0};
 	double temperature_K_initial{0};
 	double temperature_K_current{0};
 	double H_initial{0};
@@ -71,36 +254,62 @@ struct OptimizationItem final
 	Numbers number;
 	double result_of_optimization;
 	double composition_variable;
+	// equilibrium of the neighbouring point, used as initial n
+	const Composition* start_point{nullptr};
+	// equilibrium H(T) shared by the items with the same composition
+	std::shared_ptr<EnthalpyCurve> enthalpy_curve;
 
-	OptimizationItem(const ParametersNS::Parameters& parameters_,
-					 const std::vector<int>& elements_,
-					 const SubstancesTempRangeData& temp_ranges_,
-					 const SubstancesElementComposition& subs_element_composition_,
-					 const SubstanceWeights& weights_,
-					 const Composition& amounts_,
+	OptimizationItem(const std::shared_ptr<const ProblemContext>& context_,
 					 const double initial_temperature_K,
-					 const double variable_composition = 0.0);
+					 const double variable_composition = 0.0,
+					 const GroupScales& scales_ = GroupScales{});
 #ifndef NDEBUG
 	int i;
 	~OptimizationItem();
 #endif
 	void Calculate();
+	void Calculate(const OptimizationItem& previous);
+	Amounts InitialAmount(const int id) const;
 	const std::vector<double>& GetC() const & { return c; }
 	auto GetNumbers() const { return number; }
+	const std::vector<double>& GetA() const & { return active_a ? *active_a : ordering->a; }
+	const std::vector<double>& GetB() const & { return b; }
 private:
+	void AcquireBuffers();
+	void ReleaseBuffers();
+	Amounts ScaledAmount(const int id) const;
+	Amounts SumOfInitial() const;
 	void DefineOrderOfSubstances();
-	void MakeConstraintsMatrixA();
 	void MakeConstraintsB();
 	void MakeC();
 	void MakeUB();
 	void MakeN();
+	void MakeLinearCost(std::vector<double>& cost) const;
+	void MakeLinearEstimate();
 	void Equilibrium();
 	void Equilibrium(const double temperature_K);
 	void AdiabaticTemperature();
+	void AdiabaticTemperatureBisection();
+	void AdiabaticTemperatureNewton();
+	void AdiabaticTemperatureEnthalpyCurve();
+	void AdiabaticTemperatureIsenthalpic();
+	bool IsenthalpicEquilibrium(const Segment& segment, double& temperature_K,
+								double& residual_K, bool& is_feasible);
+	double EnthalpyResidual(const double temperature_K);
+	void SafeguardedNewton(double T_lo, double T_hi, double T_cur, double f,
+						   bool is_hi_known, const EnthalpyCurve* curve);
 	void H_kJ_Initial();
 	double H_kJ_Current();
-	bool IsExistAtCurrentTemperature(const int sub_id);
+	double Cp_kJ_Current();
+	bool IsExistAtCurrentTemperature(const int index);
+	bool IsFeasible() const;
 	double Minimize(const nlopt::algorithm algorithm, nlopt::result& result);
+	void MinimizeByNLopt();
+	bool MinimizeByElementPotentials();
+	bool MinimizeByDual();
+	bool MinimizeLinear();
+	bool MinimizeByActiveSet();
+	bool MinimizeByBlocks();
 	void MakeAmountsOfEquilibrium();
 };
 
@@ -113,12 +322,25 @@ class OptimizationVector
 
 using OptimizationVector = std::vector<OptimizationItem>;
 
+// Items of the chain are calculated sequentially, each of them starts
+// from the equilibrium of the previous one (continuation).
+struct Chain
+{
+	size_t first{0};
+	size_t size{0};
+};
+using OptimizationChains = std::vector<Chain>;
+
+void CalculateChain(OptimizationVector& items, const Chain& chain);
+
 class OptimizationItemsMaker final
 {
 	ParametersNS::Parameters parameters;
+	std::shared_ptr<const ProblemContext> context;
 	size_t number_of_substances{0};	// N
 	Amounts sum;
 	OptimizationVector items;
+	OptimizationChains chains;
 	int x_size{0};
 	int y_size{0};
 public:
@@ -133,19 +355,62 @@ public:
 	~OptimizationItemsMaker();
 #endif
 	OptimizationVector& GetData() & { return items; }
+	OptimizationChains& GetChains() & { return chains; }
 	auto GetXSize() const { return x_size; }
 	auto GetYSize() const { return y_size; }
 
 private:
-	std::vector<double> MakeTemperatureVector();
 	std::vector<double> MakeCompositionVector();
-	Composition MakeNewAmount(const Composition& amounts,
-							  const SubstanceWeights& weights,
-							  const double value);
-	auto MakeNewAmounts(const Composition& amounts,
-						const SubstanceWeights& weights);
+	void MakeChains(const size_t rows, const size_t row_size);
+	void MakeEnthalpyCurves();
+	GroupScales MakeGroupScale(const double value);
+	auto MakeGroupScales();
 };
 
+// Minimum of cost x subject to A x = b, 0 <= x <= ub by the two-phase
+// simplex method with the bounded variables on a dense tableau. Bland's rule
+// is used, so the degenerate vertices of the stoichiometric phases do not
+// cycle. A is M x N by rows, the columns with ub = 0 are fixed at zero,
+// ub = max of double is no bound. False if the problem is infeasible,
+// unbounded or the iterations are exhausted.
+struct SimplexSolver
+{
+	static constexpr double epsilon_pivot = 1.0E-11;
+	static constexpr double epsilon_cost = 1.0E-12;
+	static constexpr double epsilon_feasibility = 1.0E-10;
+	size_t M{0};
+	size_t N{0};
+	size_t width{0};	// the columns of x, the artificial ones and b
+	double scale{0};	// of b
+	// M + 1 rows, the last is the reduced costs, the column of b is
+	// the basic variables with the nonbasic ones at their bounds
+	std::vector<double> tableau;
+	std::vector<size_t> basis;
+	std::vector<char> is_allowed;	// the columns which can enter the basis
+	std::vector<char> is_upper;		// the nonbasic columns at the upper bound
+	std::vector<char> has_bound;	// the columns with ub < max of double
+	std::vector<double> bound;		// scaled ub
+
+	bool Solve(const double* a, const size_t M_, const size_t N_,
+			   const std::vector<double>& b, const std::vector<double>& cost,
+			   const std::vector<double>& ub, std::vector<double>& x);
+	void Interior(const double delta, const size_t mixtures,
+				  const std::vector<double>& ub, std::vector<double>& x);
+private:
+	double& At(const size_t i, const size_t k) { return tableau[i * width + k]; }
+	void Pivot(const size_t row, const size_t column);
+	void Shift(const size_t column, const double value);
+	void Enter(const size_t row, const size_t column);
+	bool Iterate(const double epsilon);
+};
+
+// Nonnegative least squares min |A y - rhs|, y >= 0, A is rows x cols
+// by columns. False if a subproblem is singular.
+bool NonNegativeLeastSquares(const std::vector<double>& columns,
+							 const std::vector<double>& rhs,
+							 const size_t rows, const size_t cols,
+							 std::vector<double>& y);
+
 } // namespace Optimization
 
 #endif // OPTIMIZATION_H
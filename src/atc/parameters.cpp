@@ -96,6 +96,34 @@ const QStringList minimization_function{
 	QT_TR_NOOP("Gibbs energy"),
 	QT_TR_NOOP("Entropy")
 };
+const QStringList continuation{
+	QT_TR_NOOP("Disable"),
+	QT_TR_NOOP("Enable")
+};
+const QStringList adiabatic_solver{
+	QT_TR_NOOP("Bisection"),
+	QT_TR_NOOP("Newton"),
+	QT_TR_NOOP("Enthalpy curve"),
+	QT_TR_NOOP("Isenthalpic")
+};
+const QStringList surrogate{
+	QT_TR_NOOP("Disable"),
+	QT_TR_NOOP("Enable")
+};
+const QStringList equilibrium_solver{
+	QT_TR_NOOP("NLopt"),
+	QT_TR_NOOP("Element potentials"),
+	QT_TR_NOOP("Dual"),
+	QT_TR_NOOP("NLopt, active set")
+};
+const QStringList initial_estimate{
+	QT_TR_NOOP("Half of upper bounds"),
+	QT_TR_NOOP("Linear programming")
+};
+const QStringList decomposition{
+	QT_TR_NOOP("Disable"),
+	QT_TR_NOOP("Enable")
+};
 constexpr double min_Kelvin = 0.0;
 constexpr double min_Celsius = -273.15;
 constexpr double min_Fahrenheit = -459.67;
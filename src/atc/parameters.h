@@ -104,6 +104,46 @@ enum class MinimizationFunction {
 };
 extern const QStringList minimization_function;
 
+enum class Continuation {
+	Disable,
+	Enable
+};
+extern const QStringList continuation;
+
+enum class AdiabaticSolver {
+	Bisection,
+	Newton,
+	EnthalpyCurve,
+	Isenthalpic
+};
+extern const QStringList adiabatic_solver;
+
+enum class Surrogate {
+	Disable,
+	Enable
+};
+extern const QStringList surrogate;
+
+enum class EquilibriumSolver {
+	NLopt,
+	ElementPotentials,
+	Dual,
+	ActiveSet
+};
+extern const QStringList equilibrium_solver;
+
+enum class InitialEstimate {
+	HalfOfUB,
+	Linear
+};
+extern const QStringList initial_estimate;
+
+enum class Decomposition {
+	Disable,
+	Enable
+};
+extern const QStringList decomposition;
+
 struct Range {
 	double start, stop, step;
 };
@@ -118,6 +158,8 @@ struct ShowPhases {
 
 constexpr int at_accuracy_min{0}; // digits after the
 constexpr int at_accuracy_max{4}; // decimal point
+constexpr int surrogate_accuracy_min{4};	// relative error
+constexpr int surrogate_accuracy_max{14};	// 10^-digits
 
 struct Parameters
 {
@@ -128,6 +170,12 @@ struct Parameters
 	Database		database			{Database::Thermo};
 	MinimizationFunction minimization_function {MinimizationFunction::GibbsEnergy};
 	Extrapolation	extrapolation		{Extrapolation::Enable};
+	Continuation	continuation		{Continuation::Disable};
+	AdiabaticSolver	adiabatic_solver	{AdiabaticSolver::Bisection};
+	Surrogate		surrogate			{Surrogate::Disable};
+	EquilibriumSolver equilibrium_solver {EquilibriumSolver::NLopt};
+	InitialEstimate	initial_estimate	{InitialEstimate::HalfOfUB};
+	Decomposition	decomposition		{Decomposition::Disable};
 	TemperatureUnit	temperature_initial_unit {TemperatureUnit::Kelvin};
 	PressureUnit	pressure_initial_unit {PressureUnit::MPa};
 	CompositionUnit composition_range_unit	{CompositionUnit::AtomicPercent};
@@ -140,6 +188,7 @@ struct Parameters
 	Range			pressure_range		{  0.1,    1.0,  0.1};
 	int				threads				{1};
 	int				at_accuracy			{1}; // digits after the decimal point
+	int				surrogate_accuracy	{10}; // relative error 10^-digits
 	ShowPhases		show_phases			{};
 	QStringList		checked_elements;
 	TemperatureUnit	temperature_result_unit {TemperatureUnit::Kelvin};
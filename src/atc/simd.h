@@ -0,0 +1,79 @@
+/* This file is part of ATC (Adiabatic Temperature Calculator).
+ * Copyright (c) 2025 Alexandr Shchukin
+ * Corresponding email: shchukin.aleksandr.sergeevich@gmail.com
+ *
+ * ATC (Adiabatic Temperature Calculator) is free software:
+ * you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * ATC (Adiabatic Temperature Calculator) is distributed in the hope that
+ * it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ATC (Adiabatic Temperature Calculator).
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+namespace Simd {
+
+inline __m256d MulAdd(const __m256d a, const __m256d b, const __m256d c)
+{
+#if defined(__FMA__) || defined(_MSC_VER)
+	return _mm256_fmadd_pd(a, b, c);
+#else
+	return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+}
+
+// Natural logarithm of 4 positive normal values.
+// y = m * 2^e, m in [sqrt(1/2), sqrt(2)), log(m) = 2*atanh(s),
+// s = (m - 1)/(m + 1), |s| < 0.1716, the series is cut after s^19,
+// the relative error of the last term is below 1E-16.
+inline __m256d Log(const __m256d y)
+{
+	const __m256d one = _mm256_set1_pd(1.0);
+	const __m256i bits = _mm256_castpd_si256(y);
+	// the biased exponent is converted to double
+	// by placing it into the mantissa of 2^52
+	const __m256d two52 = _mm256_set1_pd(0x1p52);
+	__m256d e = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(
+			_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(two52))), two52);
+	e = _mm256_sub_pd(e, _mm256_set1_pd(1023.0));
+	__m256d m = _mm256_castsi256_pd(_mm256_or_si256(
+			_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFF)),
+			_mm256_castpd_si256(one)));
+	const __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(1.4142135623730951), _CMP_GT_OQ);
+	m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+	e = _mm256_add_pd(e, _mm256_and_pd(big, one));
+	const __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+	const __m256d z = _mm256_mul_pd(s, s);
+	__m256d p = _mm256_set1_pd(1.0 / 19);
+	for(double k : {17.0, 15.0, 13.0, 11.0, 9.0, 7.0, 5.0, 3.0, 1.0}) {
+		p = MulAdd(p, z, _mm256_set1_pd(1.0 / k));
+	}
+	// log(y) = e*ln2 + 2*s*p, ln2 is split to keep the precision
+	const __m256d log_m = _mm256_mul_pd(_mm256_add_pd(s, s), p);
+	return MulAdd(e, _mm256_set1_pd(0x1.62e42fefa38p-1),
+				  MulAdd(e, _mm256_set1_pd(0x1.ef35793c7673p-45), log_m));
+}
+
+inline double HorizontalSum(const __m256d x)
+{
+	const __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(x),
+								   _mm256_extractf128_pd(x, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+} // namespace Simd
+#endif // __AVX2__
+
+#endif // SIMD_H
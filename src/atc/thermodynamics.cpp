@@ -18,6 +18,7 @@
  */
 
 #include "thermodynamics.h"
+#include "simd.h"
 #include <cmath>
 
 namespace Thermodynamics {
@@ -70,25 +71,66 @@ const TempRangeData& FindCoef(const double temperature_K,
 							  const SubstanceTempRangeData& coefs)
 {
 	assert(coefs.size() > 0 && "coefs.size() == 0");
-	if(temperature_K < coefs[0].T_min) {
-		return coefs[0];
+	// the first range which ends above T, the last one if there is no such,
+	// T below the first range gets the first one too
+	return *std::upper_bound(coefs.cbegin(), std::prev(coefs.cend()), temperature_K,
+							 [](const double T, const TempRangeData& coef){
+		return T < coef.T_max; });
+}
+
+const TempRangeData& FindCoef(const double temperature_K,
+							  const SubstanceTempRangeData& coefs, size_t& hint)
+{
+	assert(coefs.size() > 0 && "coefs.size() == 0");
+	const auto data = coefs.constData();
+	const auto size = static_cast<size_t>(coefs.size());
+	const auto is_found = [temperature_K, data, size](const size_t k){
+		return k < size && (k == 0 || data[k - 1].T_max <= temperature_K) &&
+				(k + 1 == size || temperature_K < data[k].T_max); };
+	if(!is_found(hint)) {
+		if(is_found(hint + 1)) {
+			++hint;
+		} else {
+			hint = static_cast<size_t>(&FindCoef(temperature_K, coefs) - data);
+		}
 	}
-#if 1
-	for(const auto& it : coefs) {
-		if(temperature_K < it.T_max) return it;
+	return data[hint];
+}
+
+void CoefficientsBlock::Resize(const size_t size)
+{
+	for(auto v : {&H, &f1, &f2, &f3, &f4, &f5, &f6, &f7}) {
+		v->resize(size);
 	}
-	return coefs[coefs.size()-1];
-#else
-	auto f = std::find_if(coefs.cbegin(), coefs.cend(),
-						  [temperature_K](const auto& coef){
-		return temperature_K < coef.T_max;
-	});
-	if(f == coefs.cend()) {
-		return *coefs.crbegin(); // coefs[coefs.size()-1];
-	} else {
-		return *f;
+}
+
+void CoefficientsBlock::Set(const size_t k, const TempRangeData& coef)
+{
+	H[k] = coef.H;
+	f1[k] = coef.f1;
+	f2[k] = coef.f2;
+	f3[k] = coef.f3;
+	f4[k] = coef.f4;
+	f5[k] = coef.f5;
+	f6[k] = coef.f6;
+	f7[k] = coef.f7;
+}
+
+void PropertiesBlock::Resize(const size_t size)
+{
+	for(auto v : {&G_kJ, &H_kJ, &F_J, &S_J, &Cp_J, &c}) {
+		v->resize(size);
 	}
-#endif
+}
+
+void PropertiesBlock::Set(const size_t k, const Properties& p)
+{
+	G_kJ[k] = p.G_kJ;
+	H_kJ[k] = p.H_kJ;
+	F_J[k] = p.F_J;
+	S_J[k] = p.S_J;
+	Cp_J[k] = p.Cp_J;
+	c[k] = p.c;
 }
 
 namespace Thermo {
@@ -167,6 +209,120 @@ double TF_Tv(const double temperature_K, const TempRangeData& coef)
 			Thermo::TF_S_J(temperature_K, coef));
 }
 
+// FEF polynomials, the same expressions as in the functions above
+static Properties FEF(const double temperature_K, const double H,
+					  const double f1, const double f2, const double f3,
+					  const double f4, const double f5, const double f6,
+					  const double f7)
+{
+	const double x = temperature_K * 1.0E-04;
+	const double log_x = std::log(x);
+	const double x2 = x * x;
+	Properties p;
+	p.F_J = (f1 + (f2 * log_x) + (f3 / x2) + (f4 / x) +
+			 x * (f5 + x * (f6 + f7 * x)));
+	p.G_kJ = (H - (temperature_K * p.F_J * 1.0E-03));
+	p.H_kJ = (((((3 * f7 * x + 2 * f6) * x + f5) * x + f2) * x -
+			   f4 - (2 * f3 / x)) * 10 + H);
+	p.S_J = (f1 + f2 * (1 + log_x) - (f3 / x2) +
+			 ((4 * f7 * x + 3 * f6) * x + 2 * f5) * x);
+	double Cp = (f2 + 2 * (((2 * f7 * x + f6) * 3 * x + f5) * x + f3 / x2));
+	p.Cp_J = Cp < 0.0 ? 0.0 : Cp;
+	p.c = ((1000 * H / (Thermodynamics::R * temperature_K)) -
+		   (p.F_J / Thermodynamics::R));
+	return p;
+}
+
+Properties TF_Properties(const double temperature_K, const TempRangeData& coef)
+{
+	return FEF(temperature_K, coef.H, coef.f1, coef.f2, coef.f3, coef.f4,
+			   coef.f5, coef.f6, coef.f7);
+}
+
+// temperatures_K[k * step], step is 0 for the same temperature
+static void FEF(const double* temperatures_K, const size_t step,
+				const CoefficientsBlock& coefs, PropertiesBlock& properties)
+{
+	const size_t size = coefs.Size();
+	properties.Resize(size);
+	size_t k = 0;
+#ifdef __AVX2__
+	auto set = [](const double v){ return _mm256_set1_pd(v); };
+	for(; k + 4 <= size; k += 4) {
+		auto load = [k](const std::vector<double>& v){
+			return _mm256_loadu_pd(v.data() + k); };
+		auto store = [k](std::vector<double>& v, const __m256d x){
+			_mm256_storeu_pd(v.data() + k, x); };
+		const __m256d T = step ? _mm256_loadu_pd(temperatures_K + k) :
+								 set(*temperatures_K);
+		const __m256d H = load(coefs.H);
+		const __m256d f1 = load(coefs.f1);
+		const __m256d f2 = load(coefs.f2);
+		const __m256d f3 = load(coefs.f3);
+		const __m256d f4 = load(coefs.f4);
+		const __m256d f5 = load(coefs.f5);
+		const __m256d f6 = load(coefs.f6);
+		const __m256d f7 = load(coefs.f7);
+		const __m256d x = _mm256_mul_pd(T, set(1.0E-04));
+		const __m256d log_x = Simd::Log(x);
+		const __m256d x2 = _mm256_mul_pd(x, x);
+		const __m256d f3_x2 = _mm256_div_pd(f3, x2);
+		// F = f1 + f2*log(x) + f3/x^2 + f4/x + x*(f5 + x*(f6 + f7*x))
+		__m256d poly = _mm256_add_pd(f6, _mm256_mul_pd(f7, x));
+		poly = _mm256_add_pd(f5, _mm256_mul_pd(x, poly));
+		const __m256d F = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(
+				_mm256_add_pd(f1, _mm256_mul_pd(f2, log_x)), f3_x2),
+				_mm256_div_pd(f4, x)), _mm256_mul_pd(x, poly));
+		store(properties.F_J, F);
+		store(properties.G_kJ, _mm256_sub_pd(H, _mm256_mul_pd(
+				_mm256_mul_pd(T, F), set(1.0E-03))));
+		// H = ((((3*f7*x + 2*f6)*x + f5)*x + f2)*x - f4 - 2*f3/x)*10 + H
+		poly = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(set(3.0), f7), x),
+							 _mm256_mul_pd(set(2.0), f6));
+		poly = _mm256_add_pd(_mm256_mul_pd(poly, x), f5);
+		poly = _mm256_add_pd(_mm256_mul_pd(poly, x), f2);
+		poly = _mm256_sub_pd(_mm256_sub_pd(_mm256_mul_pd(poly, x), f4),
+							 _mm256_div_pd(_mm256_mul_pd(set(2.0), f3), x));
+		store(properties.H_kJ, _mm256_add_pd(_mm256_mul_pd(poly, set(10.0)), H));
+		// S = f1 + f2*(1 + log(x)) - f3/x^2 + ((4*f7*x + 3*f6)*x + 2*f5)*x
+		poly = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(set(4.0), f7), x),
+							 _mm256_mul_pd(set(3.0), f6));
+		poly = _mm256_add_pd(_mm256_mul_pd(poly, x), _mm256_mul_pd(set(2.0), f5));
+		store(properties.S_J, _mm256_add_pd(_mm256_sub_pd(_mm256_add_pd(f1,
+				_mm256_mul_pd(f2, _mm256_add_pd(set(1.0), log_x))), f3_x2),
+				_mm256_mul_pd(poly, x)));
+		// Cp = f2 + 2*(((2*f7*x + f6)*3*x + f5)*x + f3/x^2), Cp >= 0
+		poly = _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(set(2.0), f7), x), f6);
+		poly = _mm256_mul_pd(_mm256_mul_pd(poly, set(3.0)), x);
+		poly = _mm256_add_pd(_mm256_mul_pd(_mm256_add_pd(poly, f5), x), f3_x2);
+		store(properties.Cp_J, _mm256_max_pd(_mm256_add_pd(f2,
+				_mm256_mul_pd(set(2.0), poly)), _mm256_setzero_pd()));
+		// c = 1000*H/(R*T) - F/R
+		store(properties.c, _mm256_sub_pd(
+				_mm256_div_pd(_mm256_mul_pd(set(1000.0), H),
+							  _mm256_mul_pd(set(Thermodynamics::R), T)),
+				_mm256_div_pd(F, set(Thermodynamics::R))));
+	}
+#endif
+	for(; k != size; ++k) {
+		properties.Set(k, FEF(temperatures_K[k * step], coefs.H[k], coefs.f1[k],
+							  coefs.f2[k], coefs.f3[k], coefs.f4[k], coefs.f5[k],
+							  coefs.f6[k], coefs.f7[k]));
+	}
+}
+
+void TF_Properties(const double* temperatures_K, const CoefficientsBlock& coefs,
+				   PropertiesBlock& properties)
+{
+	FEF(temperatures_K, 1, coefs, properties);
+}
+
+void TF_Properties(const double temperature_K, const CoefficientsBlock& coefs,
+				   PropertiesBlock& properties)
+{
+	FEF(&temperature_K, 0, coefs, properties);
+}
+
 double TF_F_J(const double temperature_K, const SubstanceTempRangeData& coefs)
 {
 	return TF_F_J(temperature_K, FindCoef(temperature_K, coefs));
@@ -199,6 +355,11 @@ double TF_Tv(const double temperature_K, const SubstanceTempRangeData& coefs)
 {
 	return TF_Tv(temperature_K, FindCoef(temperature_K, coefs));
 }
+Properties TF_Properties(const double temperature_K,
+						 const SubstanceTempRangeData& coefs)
+{
+	return TF_Properties(temperature_K, FindCoef(temperature_K, coefs));
+}
 } // namespace Thermo
 
 
@@ -232,6 +393,58 @@ double IntegralOfCpByT_J(const double temperature_K, const TempRangeData& coef)
 	return ((A * std::log(T)) + (1.0E-3 * B * T) - (5.0E4 * C / T2) +
 			(5.0E-7 * D * T2) + (((-1.0E8 * E / T3) + (1.0E-9 * F * T3)) / 3));
 }
+void MakeIntegrationConstants(SubstanceTempRangeData& coefs)
+{
+	// H(T) = H_below + IntegralOfCp(T) for T < T0 and
+	// H(T) = H_above + IntegralOfCp(T) for T >= T0 inside the range of T,
+	// the same for S. Ranges are added as in the integration from T0.
+	if(coefs.isEmpty()) {
+		return;
+	}
+	auto first = coefs.begin();
+	double H{first->H};
+	double S{first->S};
+	for(auto coef = coefs.end(); coef != first;) {
+		--coef;
+		if(coef->T_min >= Thermodynamics::T0) {
+			continue;
+		}
+		if(coef != first) {
+			H -= coef->H;
+			S -= coef->S;
+		}
+		auto T_max = std::min(coef->T_max, Thermodynamics::T0);
+		coef->H_below = H - HSC::IntegralOfCp_kJ(T_max, *coef);
+		coef->S_below = S - HSC::IntegralOfCpByT_J(T_max, *coef);
+		H -= HSC::IntegralOfCp_kJ(T_max, *coef) -
+				HSC::IntegralOfCp_kJ(coef->T_min, *coef);
+		S -= HSC::IntegralOfCpByT_J(T_max, *coef) -
+				HSC::IntegralOfCpByT_J(coef->T_min, *coef);
+	}
+	if(first->T_min >= Thermodynamics::T0) {
+		// extrapolation of the first range below T0
+		first->H_below = first->H - HSC::IntegralOfCp_kJ(first->T_min, *first);
+		first->S_below = first->S - HSC::IntegralOfCpByT_J(first->T_min, *first);
+	}
+	H = first->H;
+	S = first->S;
+	for(auto coef = first, end = coefs.end(); coef != end; ++coef) {
+		if(coef->T_max <= Thermodynamics::T0) {
+			continue;
+		}
+		if(coef != first && coef->T_min > Thermodynamics::T0) {
+			H += coef->H;
+			S += coef->S;
+		}
+		auto T_min = std::max(coef->T_min, Thermodynamics::T0);
+		coef->H_above = H - HSC::IntegralOfCp_kJ(T_min, *coef);
+		coef->S_above = S - HSC::IntegralOfCpByT_J(T_min, *coef);
+		H += HSC::IntegralOfCp_kJ(coef->T_max, *coef) -
+				HSC::IntegralOfCp_kJ(T_min, *coef);
+		S += HSC::IntegralOfCpByT_J(coef->T_max, *coef) -
+				HSC::IntegralOfCpByT_J(T_min, *coef);
+	}
+}
 double TF_F_J(const double temperature_K, const SubstanceTempRangeData& coefs)
 {
 	return -((1.0E3 * HSC::TF_G_kJ(temperature_K, coefs) -
@@ -242,71 +455,71 @@ double TF_G_kJ(const double temperature_K, const SubstanceTempRangeData& coefs)
 	return (HSC::TF_H_kJ(temperature_K, coefs) -
 			1.0E-3 * temperature_K * HSC::TF_S_J(temperature_K, coefs));
 }
-double TF_H_kJ(const double temperature_K, const SubstanceTempRangeData& coefs)
+// Range of T for H and S, H(T) = H_below or H_above + IntegralOfCp(x),
+// see MakeIntegrationConstants. When coef is nullptr, H and S are equal
+// to the values of the first range.
+struct IntegrationRange
 {
+	const TempRangeData* coef{nullptr};
+	double x{0};
+	bool below{false};
+};
+
+static IntegrationRange FindIntegrationRange(const double temperature_K,
+											 const SubstanceTempRangeData& coefs)
+{
+	const double T = temperature_K;
 	auto first = coefs.cbegin();
 	auto last = std::prev(coefs.cend());
-
-	double H{first->H};
-
-	if(temperature_K < Thermodynamics::T0)
-	{
-		if(temperature_K < first->T_min) {
-			H -= HSC::IntegralOfCp_kJ(first->T_min, *first) -
-					HSC::IntegralOfCp_kJ(temperature_K, *first);
-		}
-		// temperature_K >= first->T_min
-		for(auto coef = coefs.cbegin(), end = coefs.cend(); coef != end; ++coef)
-		{
-			if(coef->T_min >= Thermodynamics::T0) {
-				break;
-			}
-			// coef->T_min < Thermodynamic::T0
-			if(temperature_K >= coef->T_max) {
-				continue;
+	if(T < Thermodynamics::T0) {
+		// the first range which ends above T and begins below T0
+		auto coef = std::partition_point(first, coefs.cend(), [T](const TempRangeData& c){
+			return c.T_min < Thermodynamics::T0 && c.T_max <= T; });
+		if(coef == coefs.cend() || coef->T_min >= Thermodynamics::T0) {
+			// no ranges between T and T0
+			if(T < first->T_min) {
+				return IntegrationRange{&*first, T, true};
 			}
-			// temperature_K < coef->T_max
-			if(coef != first) {
-				H -= coef->H;
-			}
-			auto T_min = std::max(coef->T_min, temperature_K);
-			auto T_max = std::min(coef->T_max, Thermodynamics::T0);
-			assert(T_max >= T_min);
-
-			auto H_min = HSC::IntegralOfCp_kJ(T_min, *coef);
-			auto H_max = HSC::IntegralOfCp_kJ(T_max, *coef);
-			H -= H_max - H_min;
+			return IntegrationRange{};
 		}
-	} else { // temperature_K >= Thermodynamics::T0
-		for(auto coef = coefs.cbegin(), end = coefs.cend(); coef != end; ++coef)
-		{
-			if(coef->T_max <= Thermodynamics::T0) {
-				continue;
-			}
-			// coef->T_max > Thermodynamics::T0
-			if(coef->T_min >= temperature_K) {
-				break;
-			}
-			// coef->T_min <= temperature_K
-
-			if(coef != first && coef->T_min > Thermodynamics::T0) {
-				H += coef->H;
-			}
-			auto T_min = std::max(coef->T_min, Thermodynamics::T0);
-			auto T_max = std::min(coef->T_max, temperature_K);
-			assert(T_max >= T_min);
+		return IntegrationRange{&*coef, coef == first ? T : std::max(coef->T_min, T),
+								true};
+	} else {
+		// the last range which begins below T
+		auto next = std::partition_point(first, coefs.cend(),
+										 [T](const TempRangeData& c){ return c.T_min < T; });
+		if(next == first || std::prev(next)->T_max <= Thermodynamics::T0) {
+			return IntegrationRange{};
+		}
+		auto coef = std::prev(next);
+		return IntegrationRange{&*coef, coef == last ? T : std::min(coef->T_max, T),
+								false};
+	}
+}
 
-			auto H_min = HSC::IntegralOfCp_kJ(T_min, *coef);
-			auto H_max = HSC::IntegralOfCp_kJ(T_max, *coef);
-			H += H_max - H_min;
+static double IntegratedH_kJ(const IntegrationRange& range,
+							 const SubstanceTempRangeData& coefs)
+{
+	if(!range.coef) {
+		return coefs.cbegin()->H;
+	}
+	return (range.below ? range.coef->H_below : range.coef->H_above) +
+			HSC::IntegralOfCp_kJ(range.x, *range.coef);
+}
 
-			if(coef == last && temperature_K > coef->T_max) {
-				H += HSC::IntegralOfCp_kJ(temperature_K, *coef) -
-						HSC::IntegralOfCp_kJ(coef->T_max, *coef);
-			}
-		}
+static double IntegratedS_J(const IntegrationRange& range,
+							const SubstanceTempRangeData& coefs)
+{
+	if(!range.coef) {
+		return coefs.cbegin()->S;
 	}
-	return H;
+	return (range.below ? range.coef->S_below : range.coef->S_above) +
+			HSC::IntegralOfCpByT_J(range.x, *range.coef);
+}
+
+double TF_H_kJ(const double temperature_K, const SubstanceTempRangeData& coefs)
+{
+	return IntegratedH_kJ(FindIntegrationRange(temperature_K, coefs), coefs);
 }
 double TF_H_J(const double temperature_K, const SubstanceTempRangeData& coefs)
 {
@@ -314,68 +527,7 @@ double TF_H_J(const double temperature_K, const SubstanceTempRangeData& coefs)
 }
 double TF_S_J(const double temperature_K, const SubstanceTempRangeData& coefs)
 {
-	auto first = coefs.cbegin();
-	auto last = std::prev(coefs.cend());
-
-	double S{first->S};
-
-	if(temperature_K < Thermodynamics::T0)
-	{
-		if(temperature_K < first->T_min) {
-			S -= HSC::IntegralOfCpByT_J(first->T_min, *first) -
-					HSC::IntegralOfCpByT_J(temperature_K, *first);
-		}
-		for(auto coef = coefs.cbegin(), end = coefs.cend(); coef != end; ++coef)
-		{
-			if(coef->T_min >= Thermodynamics::T0) {
-				break;
-			}
-			// coef->T_min < Thermodynamic::T0
-			if(temperature_K >= coef->T_max) {
-				continue;
-			}
-			// temperature_K < coef->T_max
-			if(coef != first) {
-				S -= coef->S;
-			}
-			auto T_min = std::max(coef->T_min, temperature_K);
-			auto T_max = std::min(coef->T_max, Thermodynamics::T0);
-			assert(T_max >= T_min);
-
-			auto S_min = HSC::IntegralOfCpByT_J(T_min, *coef);
-			auto S_max = HSC::IntegralOfCpByT_J(T_max, *coef);
-			S -= S_max - S_min;
-		}
-	} else { // temperature_K >= Thermodynamics::T0
-		for(auto coef = coefs.cbegin(), end = coefs.cend(); coef != end; ++coef)
-		{
-			if(coef->T_max <= Thermodynamics::T0) {
-				continue;
-			}
-			// coef->T_max > Thermodynamics::T0
-			if(coef->T_min >= temperature_K) {
-				break;
-			}
-			// coef->T_min <= temperature_K
-
-			if(coef != first && coef->T_min > Thermodynamics::T0) {
-				S += coef->S;
-			}
-			auto T_min = std::max(coef->T_min, Thermodynamics::T0);
-			auto T_max = std::min(coef->T_max, temperature_K);
-			assert(T_max >= T_min);
-
-			auto S_min = HSC::IntegralOfCpByT_J(T_min, *coef);
-			auto S_max = HSC::IntegralOfCpByT_J(T_max, *coef);
-			S += S_max - S_min;
-
-			if(coef == last && temperature_K > coef->T_max) {
-				S += HSC::IntegralOfCpByT_J(temperature_K, *coef) -
-						HSC::IntegralOfCpByT_J(coef->T_max, *coef);
-			}
-		}
-	}
-	return S;
+	return IntegratedS_J(FindIntegrationRange(temperature_K, coefs), coefs);
 }
 double TF_Cp_J(const double temperature_K, const SubstanceTempRangeData& coefs)
 {
@@ -403,8 +555,55 @@ double TF_Tv(const double temperature_K, const SubstanceTempRangeData& coefs)
 	return (HSC::TF_H_J(temperature_K, coefs) /
 			HSC::TF_S_J(temperature_K, coefs));
 }
+Properties TF_Properties(const double temperature_K,
+						 const SubstanceTempRangeData& coefs)
+{
+	auto range = FindIntegrationRange(temperature_K, coefs);
+	Properties p;
+	p.H_kJ = IntegratedH_kJ(range, coefs);
+	p.S_J = IntegratedS_J(range, coefs);
+	p.G_kJ = (p.H_kJ - 1.0E-3 * temperature_K * p.S_J);
+	p.F_J = -((1.0E3 * p.G_kJ - HSC::TF_H_J(298.15, coefs)) / temperature_K);
+	p.Cp_J = HSC::TF_Cp_J(temperature_K, coefs);
+	p.c = (1.0E3 * p.G_kJ / (Thermodynamics::R * temperature_K));
+	return p;
+}
 } // namespace HSC
 
+// All thermodynamic functions for the temperatures
+static PropertiesBlock TabulateProperties(const QVector<double>& kelvins,
+										  const ParametersNS::Database& database,
+										  const SubstanceTempRangeData& coefs)
+{
+	const auto size = static_cast<size_t>(kelvins.size());
+	PropertiesBlock properties;
+	switch(database) {
+	case ParametersNS::Database::Thermo: {
+		CoefficientsBlock block;
+		block.Resize(size);
+		size_t hint = 0; // the temperatures are usually ascending
+		for(size_t i = 0; i != size; ++i) {
+			block.Set(i, FindCoef(kelvins[static_cast<int>(i)], coefs, hint));
+		}
+		Thermo::TF_Properties(kelvins.constData(), block, properties);
+	}
+		break;
+	case ParametersNS::Database::HSC:
+		properties.Resize(size);
+		for(size_t i = 0; i != size; ++i) {
+			properties.Set(i, HSC::TF_Properties(kelvins[static_cast<int>(i)], coefs));
+		}
+		break;
+	}
+	return properties;
+}
+
+static void Assign(const std::vector<double>& from, QVector<double>& to)
+{
+	to.resize(static_cast<int>(from.size()));
+	std::copy(from.cbegin(), from.cend(), to.begin());
+}
+
 SubstancesTabulatedTFData
 Tabulate(const ParametersNS::Range& temperature_range,
 		 const ParametersNS::TemperatureUnit& unit,
@@ -424,46 +623,16 @@ Tabulate(const ParametersNS::Range& temperature_range,
 
 	// TODO tabulate by diapasons
 	RangeTabulator(range_in_unit, data.temperatures);
-	auto size = data.temperatures.size();
-	data.G_kJ.resize(size);
-	data.H_kJ.resize(size);
-	data.F_J.resize(size);
-	data.S_J.resize(size);
-	data.Cp_J.resize(size);
-	data.c.resize(size);
-	QVector<double> kelvins(size);
+	QVector<double> kelvins(data.temperatures.size());
 	std::transform(data.temperatures.cbegin(), data.temperatures.cend(),
 				   kelvins.begin(), [unit](auto t){return ToKelvin(t, unit);});
-	switch(database) {
-	case ParametersNS::Database::Thermo:
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.G_kJ.begin(),
-					   [coefs](auto t){return Thermo::TF_G_kJ(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.H_kJ.begin(),
-					   [coefs](auto t){return Thermo::TF_H_kJ(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.F_J.begin(),
-					   [coefs](auto t){return Thermo::TF_F_J(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.S_J.begin(),
-					   [coefs](auto t){return Thermo::TF_S_J(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.Cp_J.begin(),
-					   [coefs](auto t){return Thermo::TF_Cp_J(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.c.begin(),
-					   [coefs](auto t){return Thermo::TF_c(t, coefs);});
-		break;
-	case ParametersNS::Database::HSC:
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.G_kJ.begin(),
-					   [coefs](auto t){return HSC::TF_G_kJ(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.H_kJ.begin(),
-					   [coefs](auto t){return HSC::TF_H_kJ(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.F_J.begin(),
-					   [coefs](auto t){return HSC::TF_F_J(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.S_J.begin(),
-					   [coefs](auto t){return HSC::TF_S_J(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.Cp_J.begin(),
-					   [coefs](auto t){return HSC::TF_Cp_J(t, coefs);});
-		std::transform(kelvins.cbegin(), kelvins.cend(), data.c.begin(),
-					   [coefs](auto t){return HSC::TF_c(t, coefs);});
-		break;
-	}
+	auto properties = TabulateProperties(kelvins, database, coefs);
+	Assign(properties.G_kJ, data.G_kJ);
+	Assign(properties.H_kJ, data.H_kJ);
+	Assign(properties.F_J, data.F_J);
+	Assign(properties.S_J, data.S_J);
+	Assign(properties.Cp_J, data.Cp_J);
+	Assign(properties.c, data.c);
 	return data;
 }
 
@@ -485,68 +654,29 @@ void TabulateOneTF(const ParametersNS::Range& temperature_range,
 
 	x.clear();
 	RangeTabulator(range_in_unit, x);
-	auto size = x.size();
-	y.clear();
-	y.resize(size);
-	QVector<double> kelvins(size);
+	QVector<double> kelvins(x.size());
 	std::transform(x.cbegin(), x.cend(), kelvins.begin(), [unit](auto t){
 		return ToKelvin(t, unit); });
-	switch(database) {
-	case ParametersNS::Database::Thermo:
-		switch(tf) {
-		case ParametersNS::ThermodynamicFunction::G_kJ:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return Thermo::TF_G_kJ(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::H_kJ:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return Thermo::TF_H_kJ(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::F_J:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return Thermo::TF_F_J(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::S_J:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return Thermo::TF_S_J(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::Cp_J:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return Thermo::TF_Cp_J(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::c:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return Thermo::TF_c(t, coefs);});
-			break;
-		}
+	auto properties = TabulateProperties(kelvins, database, coefs);
+	y.clear();
+	switch(tf) {
+	case ParametersNS::ThermodynamicFunction::G_kJ:
+		Assign(properties.G_kJ, y);
 		break;
-	case ParametersNS::Database::HSC:
-		switch(tf) {
-		case ParametersNS::ThermodynamicFunction::G_kJ:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return HSC::TF_G_kJ(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::H_kJ:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return HSC::TF_H_kJ(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::F_J:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return HSC::TF_F_J(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::S_J:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return HSC::TF_S_J(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::Cp_J:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return HSC::TF_Cp_J(t, coefs);});
-			break;
-		case ParametersNS::ThermodynamicFunction::c:
-			std::transform(kelvins.cbegin(), kelvins.cend(), y.begin(),
-						   [coefs](auto t){return HSC::TF_c(t, coefs);});
-			break;
-		}
+	case ParametersNS::ThermodynamicFunction::H_kJ:
+		Assign(properties.H_kJ, y);
+		break;
+	case ParametersNS::ThermodynamicFunction::F_J:
+		Assign(properties.F_J, y);
+		break;
+	case ParametersNS::ThermodynamicFunction::S_J:
+		Assign(properties.S_J, y);
+		break;
+	case ParametersNS::ThermodynamicFunction::Cp_J:
+		Assign(properties.Cp_J, y);
+		break;
+	case ParametersNS::ThermodynamicFunction::c:
+		Assign(properties.c, y);
 		break;
 	}
 }
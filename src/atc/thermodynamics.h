@@ -37,6 +37,33 @@ ParametersNS::Range RangeFromKelvin(const ParametersNS::Range range,
 									const ParametersNS::TemperatureUnit tu);
 const TempRangeData& FindCoef(const double temperature_K,
 							  const SubstanceTempRangeData& coefs);
+// The hint is the index of the previous range, it is checked first with
+// its neighbour, so ascending temperatures cost O(1) per call
+const TempRangeData& FindCoef(const double temperature_K,
+							  const SubstanceTempRangeData& coefs, size_t& hint);
+
+// All thermodynamic functions for one temperature
+struct Properties
+{
+	double G_kJ{0}, H_kJ{0}, F_J{0}, S_J{0}, Cp_J{0}, c{0};
+};
+
+// Coefficients of the Thermo database as structure of arrays
+struct CoefficientsBlock
+{
+	std::vector<double> H, f1, f2, f3, f4, f5, f6, f7;
+	size_t Size() const { return H.size(); }
+	void Resize(const size_t size);
+	void Set(const size_t k, const TempRangeData& coef);
+};
+
+// Thermodynamic functions as structure of arrays
+struct PropertiesBlock
+{
+	std::vector<double> G_kJ, H_kJ, F_J, S_J, Cp_J, c;
+	void Resize(const size_t size);
+	void Set(const size_t k, const Properties& p);
+};
 
 namespace Thermo {
 double TF_F_J(const double temperature_K, const TempRangeData& coef);
@@ -47,6 +74,13 @@ double TF_S_J(const double temperature_K, const TempRangeData& coef);
 double TF_Cp_J(const double temperature_K, const TempRangeData& coef);
 double TF_c(const double temperature_K, const TempRangeData& coef);
 double TF_Tv(const double temperature_K, const TempRangeData& coef);
+Properties TF_Properties(const double temperature_K, const TempRangeData& coef);
+// element k is calculated by the coefficients k at temperatures_K[k]
+void TF_Properties(const double* temperatures_K, const CoefficientsBlock& coefs,
+				   PropertiesBlock& properties);
+// all elements at the same temperature
+void TF_Properties(const double temperature_K, const CoefficientsBlock& coefs,
+				   PropertiesBlock& properties);
 
 double TF_F_J(const double temperature_K, const SubstanceTempRangeData& coefs);
 double TF_G_kJ(const double temperature_K, const SubstanceTempRangeData& coefs);
@@ -56,9 +90,12 @@ double TF_S_J(const double temperature_K, const SubstanceTempRangeData& coefs);
 double TF_Cp_J(const double temperature_K, const SubstanceTempRangeData& coefs);
 double TF_c(const double temperature_K, const SubstanceTempRangeData& coefs);
 double TF_Tv(const double temperature_K, const SubstanceTempRangeData& coefs);
+Properties TF_Properties(const double temperature_K,
+						 const SubstanceTempRangeData& coefs);
 } // namespace Thermo
 
 namespace HSC {
+void MakeIntegrationConstants(SubstanceTempRangeData& coefs);
 double TF_F_J(const double temperature_K, const SubstanceTempRangeData& coefs);
 double TF_G_kJ(const double temperature_K, const SubstanceTempRangeData& coefs);
 double TF_H_kJ(const double temperature_K, const SubstanceTempRangeData& coefs);
@@ -67,6 +104,8 @@ double TF_S_J(const double temperature_K, const SubstanceTempRangeData& coefs);
 double TF_Cp_J(const double temperature_K, const SubstanceTempRangeData& coefs);
 double TF_c(const double temperature_K, const SubstanceTempRangeData& coefs);
 double TF_Tv(const double temperature_K, const SubstanceTempRangeData& coefs);
+Properties TF_Properties(const double temperature_K,
+						 const SubstanceTempRangeData& coefs);
 } // namespace HSC
 
 SubstancesTabulatedTFData
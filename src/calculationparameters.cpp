@@ -36,6 +36,12 @@ CalculationParameters::CalculationParameters(QWidget *parent) :
 	ui->choose_substances->addItems(ParametersNS::choose_substances);
 	ui->extrapolation->addItems(ParametersNS::extrapolation);
 	ui->minimization_function->addItems(ParametersNS::minimization_function);
+	ui->continuation->addItems(ParametersNS::continuation);
+	ui->adiabatic_solver->addItems(ParametersNS::adiabatic_solver);
+	ui->surrogate->addItems(ParametersNS::surrogate);
+	ui->equilibrium_solver->addItems(ParametersNS::equilibrium_solver);
+	ui->initial_estimate->addItems(ParametersNS::initial_estimate);
+	ui->decomposition->addItems(ParametersNS::decomposition);
 	ui->composition_units->addItems(ParametersNS::composition_units);
 	ui->temperature_initial_units->addItems(ParametersNS::temperature_units);
 	ui->temperature_units->addItems(ParametersNS::temperature_units);
@@ -80,6 +86,12 @@ ParametersNS::Parameters CalculationParameters::GetCurrentParameters()
 	p.database = static_cast<ParametersNS::Database>(ui->database->currentIndex());
 	p.minimization_function = static_cast<ParametersNS::MinimizationFunction>(ui->minimization_function->currentIndex());
 	p.extrapolation = static_cast<ParametersNS::Extrapolation>(ui->extrapolation->currentIndex());
+	p.continuation = static_cast<ParametersNS::Continuation>(ui->continuation->currentIndex());
+	p.adiabatic_solver = static_cast<ParametersNS::AdiabaticSolver>(ui->adiabatic_solver->currentIndex());
+	p.surrogate = static_cast<ParametersNS::Surrogate>(ui->surrogate->currentIndex());
+	p.equilibrium_solver = static_cast<ParametersNS::EquilibriumSolver>(ui->equilibrium_solver->currentIndex());
+	p.initial_estimate = static_cast<ParametersNS::InitialEstimate>(ui->initial_estimate->currentIndex());
+	p.decomposition = static_cast<ParametersNS::Decomposition>(ui->decomposition->currentIndex());
 	p.composition_range_unit = static_cast<ParametersNS::CompositionUnit>(ui->composition_units->currentIndex());
 	p.temperature_initial_unit = static_cast<ParametersNS::TemperatureUnit>(ui->temperature_initial_units->currentIndex());
 	p.pressure_initial_unit = static_cast<ParametersNS::PressureUnit>(ui->pressure_initial_units->currentIndex());
@@ -103,6 +115,7 @@ ParametersNS::Parameters CalculationParameters::GetCurrentParameters()
 
 	p.threads = ui->threads->value();
 	p.at_accuracy = ui->at_accuracy->value();
+	p.surrogate_accuracy = ui->surrogate_accuracy->value();
 
 	p.show_phases.gas = ui->show_gas->isChecked();
 	p.show_phases.liquid = ui->show_liquid->isChecked();
@@ -135,6 +148,12 @@ void CalculationParameters::SetupParameters(const ParametersNS::Parameters p)
 	ui->database->setCurrentIndex(static_cast<int>(p.database));
 	ui->minimization_function->setCurrentIndex(static_cast<int>(p.minimization_function));
 	ui->extrapolation->setCurrentIndex(static_cast<int>(p.extrapolation));
+	ui->continuation->setCurrentIndex(static_cast<int>(p.continuation));
+	ui->adiabatic_solver->setCurrentIndex(static_cast<int>(p.adiabatic_solver));
+	ui->surrogate->setCurrentIndex(static_cast<int>(p.surrogate));
+	ui->equilibrium_solver->setCurrentIndex(static_cast<int>(p.equilibrium_solver));
+	ui->initial_estimate->setCurrentIndex(static_cast<int>(p.initial_estimate));
+	ui->decomposition->setCurrentIndex(static_cast<int>(p.decomposition));
 	ui->temperature_initial_units->setCurrentIndex(static_cast<int>(p.temperature_initial_unit));
 	ui->pressure_initial_units->setCurrentIndex(static_cast<int>(p.pressure_initial_unit));
 	ui->composition_units->setCurrentIndex(static_cast<int>(p.composition_range_unit));
@@ -144,6 +163,9 @@ void CalculationParameters::SetupParameters(const ParametersNS::Parameters p)
 	ui->at_accuracy->setRange(ParametersNS::at_accuracy_min,
 							  ParametersNS::at_accuracy_max);
 	ui->at_accuracy->setValue(p.at_accuracy);
+	ui->surrogate_accuracy->setRange(ParametersNS::surrogate_accuracy_min,
+									 ParametersNS::surrogate_accuracy_max);
+	ui->surrogate_accuracy->setValue(p.surrogate_accuracy);
 	ui->threads->setRange(1, p.MaxThreadsCount());
 	ui->threads->setValue(p.threads);
 
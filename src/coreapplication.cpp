@@ -40,6 +40,7 @@ CoreApplication::CoreApplication(MainWindow *const gui, QObject *parent)
 	qRegisterMetaType<QVector<double>>("QVector<double>&");
 	qRegisterMetaType<QVector<QVector<double>>>("QVector<QVector<double>>&");
 	qRegisterMetaType<Optimization::OptimizationVector>("Optimization::OptimizationVector&");
+	qRegisterMetaType<Optimization::OptimizationChains>("Optimization::OptimizationChains&");
 
 	// GUI methods should be called only in this constructor,
 	// but not in any other CoreApplication methods,
@@ -82,6 +83,8 @@ CoreApplication::CoreApplication(MainWindow *const gui, QObject *parent)
 			this, &CoreApplication::SlotResieveResult);
 	connect(this, &CoreApplication::SignalError,
 			gui, &MainWindow::SlotShowError);
+	connect(this, &CoreApplication::SignalAppendStatusBarText,
+			gui, &MainWindow::SlotAppendStatusBarText);
 
 	// model plot TF
 	connect(model_plot_tf, &PlotTFModel::AddGraph,
@@ -386,7 +389,7 @@ double CoreApplication::ChooseValueInResultData(const GraphId id, const int inde
 	if(id.substance_id > 0) {
 		assert(id.option == -1);
 		const auto& val = parameters_.show_initial_in_result
-				? result_data.at(index).amounts.at(id.substance_id)
+				? result_data.at(index).InitialAmount(id.substance_id)
 				: result_data.at(index).amounts_of_equilibrium.at(id.substance_id);
 		switch (parameters_.composition_result_unit) {
 		case ParametersNS::CompositionUnit::AtomicPercent:
@@ -630,11 +633,12 @@ void CoreApplication::SlotStartCalculations()
 		return;
 	}
 	auto vec{std::move(maker->GetData())};
+	auto chains{std::move(maker->GetChains())};
 	x_size = maker->GetXSize();
 	y_size = maker->GetYSize();
 
 	// 6. emit vector
-	emit SignalStartCalculations(vec, parameters_.threads);
+	emit SignalStartCalculations(vec, chains, parameters_.threads);
 
 	LOG(">> END CALCULATION <<")
 }
@@ -648,8 +652,17 @@ void CoreApplication::SlotResieveResult(Optimization::OptimizationVector& vec)
 
 	result_data = std::move(vec);
 
-	model_result->SetNewData(&(result_data.cbegin()->weights),
+	model_result->SetNewData(&(result_data.cbegin()->context->weights),
 							 parameters_);
 	model_detail_result->SetNewData(&result_data, parameters_, x_size, y_size);
 
+	// the substances which cannot appear are not calculated
+	auto&& pruned = result_data.cbegin()->context->pruned;
+	if(!pruned.isEmpty()) {
+		QStringList formulas;
+		for(const auto& weight : pruned) {
+			formulas.push_back(weight.formula);
+		}
+		emit SignalAppendStatusBarText(tr("Excluded: %1").arg(formulas.join(", ")));
+	}
 }
@@ -77,9 +77,11 @@ signals:
 	void SignalSetPlotXAxisUnit(const ParametersNS::TemperatureUnit unit);
 
 	void SignalStartCalculations(Optimization::OptimizationVector& vec,
+								 Optimization::OptimizationChains& chains,
 								 int threads);
 
 	void SignalError(const QString& text);
+	void SignalAppendStatusBarText(const QString& text);
 
 private slots:
 	void SlotUpdate(const ParametersNS::Parameters parameters);
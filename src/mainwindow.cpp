@@ -229,6 +229,7 @@ void MainWindow::SlotSetPlotResultAxisUnit(const ParametersNS::Parameters params
 }
 
 void MainWindow::SlotStartCalculations(Optimization::OptimizationVector& vec,
+									   Optimization::OptimizationChains& chains,
 									   int threads)
 {
 	Timer t; t.start();
@@ -238,7 +239,13 @@ void MainWindow::SlotStartCalculations(Optimization::OptimizationVector& vec,
 	} else {
 		LOG(">> CALCULATION START <<")
 		QThreadPool::globalInstance()->setMaxThreadCount(threads);
-		fw->setFuture(QtConcurrent::map(vec, &Optimization::OptimizationItem::Calculate));
+		if(chains.empty()) {
+			fw->setFuture(QtConcurrent::map(vec, static_cast<void(Optimization::OptimizationItem::*)()>(
+												&Optimization::OptimizationItem::Calculate)));
+		} else {
+			fw->setFuture(QtConcurrent::map(chains, [&vec](const Optimization::Chain& chain){
+				Optimization::CalculateChain(vec, chain);}));
+		}
 		// fw->setFuture(QtConcurrent::map(vec.begin(), vec.end(), &Optimization::OptimizationItem::Calculate));
 		dialog->exec();
 		fw->waitForFinished();
@@ -279,6 +286,12 @@ void MainWindow::SlotShowStatusBarText(const QString& text)
 	statusBar()->showMessage(text);
 }
 
+void MainWindow::SlotAppendStatusBarText(const QString& text)
+{
+	LOG()
+	statusBar()->showMessage(statusBar()->currentMessage() + QStringLiteral(" ") + text);
+}
+
 void MainWindow::SlotSetAvailableElements(const QStringList& elements)
 {
 	ui->calculation_parameters->SetEnabledElements(elements);
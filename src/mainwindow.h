@@ -99,13 +99,16 @@ signals:
 	void SignalGraphsRemovedPlotResult(const QVector<GraphId>&);
 
 public slots:
-	void SlotStartCalculations(Optimization::OptimizationVector& vec, int threads);
+	void SlotStartCalculations(Optimization::OptimizationVector& vec,
+							   Optimization::OptimizationChains& chains,
+							   int threads);
 
 public slots:
 	void SlotSetAvailableElements(const QStringList& elements);
 	void SlotSetSelectedSubstanceLabel(const QString& name);
 	void SlotSetPlotXAxisUnit(const ParametersNS::TemperatureUnit unit);
 	void SlotShowStatusBarText(const QString& text);
+	void SlotAppendStatusBarText(const QString& text);
 	void SlotShowError(const QString& text);
 
 private slots:
@@ -589,9 +589,9 @@ QVariant ResultDetailModel::DataSingle(const int row, const int col, int role) c
 		if(row >= ResultFields::detail_row_names_single_size) {
 			auto i = row - ResultFields::detail_row_names_single_size;
 			auto first = items->cbegin();
-			auto id = first->weights.at(i).id;
+			auto id = first->context->weights.at(i).id;
 			const auto& val = parameters.show_initial_in_result
-					? first->amounts.at(id)
+					? first->InitialAmount(id)
 					: first->amounts_of_equilibrium.at(id);
 			switch (col) {
 			case 0: return ToQString10(val.sum_mol);
@@ -727,9 +727,9 @@ QVariant ResultDetailModel::Data1D(const int row, const int col, int role) const
 			}
 			if(col >= 1) {
 				auto j = col - 1;
-				auto id = first->weights.at(i).id;
+				auto id = first->context->weights.at(i).id;
 				const auto& val = parameters.show_initial_in_result
-						? items->at(j).amounts.at(id)
+						? items->at(j).InitialAmount(id)
 						: items->at(j).amounts_of_equilibrium.at(id);
 				switch (parameters.composition_result_unit) {
 				case ParametersNS::CompositionUnit::AtomicPercent:
@@ -856,9 +856,9 @@ QVariant ResultDetailModel::Data2D(const int row, const int col, int role) const
 			}
 			if(col >= 1) {
 				auto j = col - 1;
-				auto id = first->weights.at(i).id;
+				auto id = first->context->weights.at(i).id;
 				const auto& val = parameters.show_initial_in_result
-						? items->at(j).amounts.at(id)
+						? items->at(j).InitialAmount(id)
 						: items->at(j).amounts_of_equilibrium.at(id);
 				switch (parameters.composition_result_unit) {
 				case ParametersNS::CompositionUnit::AtomicPercent:
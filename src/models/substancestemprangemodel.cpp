@@ -104,7 +104,7 @@ QVariant SubstancesTempRangeModel::data(const QModelIndex& index, int role) cons
 	case SubstanceTempRangeFields::f5:		return QString::number(data_at.f5, 'g', 10);
 	case SubstanceTempRangeFields::f6:		return QString::number(data_at.f6, 'g', 10);
 	case SubstanceTempRangeFields::f7:		return QString::number(data_at.f7, 'g', 10);
-	case SubstanceTempRangeFields::phase:	return data_at.phase;
+	case SubstanceTempRangeFields::phase:	return ToString(data_at.phase);
 	}
 	LOG("ERROR in SubstancesTempRangeModel::data")
 	return QVariant{};
@@ -0,0 +1,281 @@
+/* This file is part of ATC (Adiabatic Temperature Calculator).
+ * Copyright (c) 2025 Alexandr Shchukin
+ * Corresponding email: shchukin.aleksandr.sergeevich@gmail.com
+ *
+ * ATC (Adiabatic Temperature Calculator) is free software:
+ * you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * ATC (Adiabatic Temperature Calculator) is distributed in the hope that
+ * it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ATC (Adiabatic Temperature Calculator).
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SYSTEMS_H
+#define SYSTEMS_H
+
+#include "database.h"
+#include "amountsmodel.h"
+#include <algorithm>
+
+// Small systems of the Thermo database for the tests of the calculation
+struct System
+{
+	std::vector<int> elements;
+	SubstancesTempRangeData temp_ranges;
+	SubstancesElementComposition subs_element_composition;
+	SubstanceWeights weights;
+	Composition amounts;
+
+	void Add(const int id, const QString& formula, const double weight,
+			 const SubstanceTempRangeData& ranges,
+			 const SubstanceElementComposition& composition)
+	{
+		weights.push_back(SubstanceWeight{{id, formula}, weight});
+		temp_ranges[id] = ranges;
+		subs_element_composition[id] = composition;
+		amounts[id] = Amounts{};
+	}
+	void Remove(const int id)
+	{
+		weights.erase(std::remove_if(weights.begin(), weights.end(),
+									 [id](const SubstanceWeight& w){ return w.id == id; }),
+					  weights.end());
+		temp_ranges.erase(id);
+		subs_element_composition.erase(id);
+		amounts.erase(id);
+	}
+	void SetAmount(const int id, const double mol)
+	{
+		auto weight = std::find_if(weights.cbegin(), weights.cend(),
+								   [id](const SubstanceWeight& w){ return w.id == id; });
+		auto&& amount = amounts.at(id);
+		amount.group_1_mol = amount.sum_mol = mol;
+		amount.group_1_gram = amount.sum_gram = mol * weight->weight;
+		GetSumAndRecalculate(amounts);
+	}
+};
+
+// C(s), CO, CO2, O and O2, elements C = 6, O = 8
+inline System CarbonOxygen()
+{
+	System system;
+	system.elements = {6, 8};
+	system.Add(713, "C1(s)", 12.011, {
+		{298.15, 1200, -1.05, 0,
+		 -3.72252, 0.849, -0.0008935, 0.133597, 193.215, -362.917, 350.083,
+		 Phase::Solid},
+		{1200, 5000, -1.05, 0,
+		 61.1076, 27.852, -0.019834, 1.79049, -14.44, 15.8333, 0,
+		 Phase::Solid},
+	}, {{6, 1}});
+	system.Add(921, "C1O1(g)", 28.0104, {
+		{298.15, 1500, -119.201, 0,
+		 255.965, 24.1184, 0.000861715, -0.15919, 54.1332, -20.6124, -60.9211,
+		 Phase::Gas},
+		{1500, 6000, -119.201, 0,
+		 277.801, 35.5784, -0.0194102, 0.958007, 5.96312, -3.68021, 1.46496,
+		 Phase::Gas},
+		{6000, 20000, -119.201, 0,
+		 305.287, -25.493, 6.01587, -48.9224, 10.948, 11.7693, -2.56327,
+		 Phase::Gas},
+	}, {{6, 1}, {8, 1}});
+	system.Add(922, "C1O2(g)", 44.0098, {
+		{298.15, 1500, -402.875, 0,
+		 264.536, 26.2022, -0.00084886, 0.104697, 255.808, -484.303, 516.704,
+		 Phase::Gas},
+		{1500, 6000, -402.875, 0,
+		 336.423, 56.8132, -0.0308805, 2.19535, 21.0948, -17.44, 8.67714,
+		 Phase::Gas},
+		{6000, 10000, -402.875, 0,
+		 408.307, 118.673, -0.441445, 14.8981, -115.298, 53.9243, -10.6377,
+		 Phase::Gas},
+	}, {{6, 1}, {8, 2}});
+	system.Add(2542, "O1(g)", 15.9994, {
+		{298.15, 1500, 242.445, 0,
+		 215.419, 21.3814, 0.000366195, -0.0643666, -6.22227, 15.9471, -21.1655,
+		 Phase::Gas},
+		{1500, 6000, 242.445, 0,
+		 217.297, 22.7493, -0.00433948, 0.133595, -7.94626, 7.10449, -2.41763,
+		 Phase::Gas},
+		{6000, 20000, 242.445, 0,
+		 211.009, 21.7631, -0.212924, 1.58133, 2.38508, -0.630479, 0.0671619,
+		 Phase::Gas},
+	}, {{8, 1}});
+	system.Add(2543, "O2(g)", 31.9988, {
+		{298.15, 1500, -8.682, 0,
+		 249.211, 20.1504, 0.00103248, -0.2266, 140.388, -295.3, 347.686,
+		 Phase::Gas},
+		{1500, 6000, -8.682, 0,
+		 278.618, 29.9343, 0.00781359, -0.0669831, 23.9328, -9.855, 2.57379,
+		 Phase::Gas},
+		{6000, 20000, -8.682, 0,
+		 290.712, 86.2171, -3.00455, 30.5095, -25.5949, 2.32299, -0.0502174,
+		 Phase::Gas},
+	}, {{8, 2}});
+	return system;
+}
+
+// H, O, H2, O2, OH and H2O gases, elements H = 1, O = 8
+inline System HydrogenOxygen()
+{
+	System system;
+	system.elements = {1, 8};
+	system.Add(1930, "H1(g)", 1.00794, {
+		{298.15, 20000, 211.8, 0,
+		 166.836, 20.786, 0, 0, 0, 0, 0,
+		 Phase::Gas},
+	}, {{1, 1}});
+	system.Add(1931, "H2(g)", 2.01588, {
+		{298.15, 1500, -8.468, 0,
+		 215.808, 33.1095, -0.000798944, 0.152529, -57.5686, 193.572, -237.176,
+		 Phase::Gas},
+		{1500, 6000, -8.468, 0,
+		 202.447, 31.3598, -0.0265618, 0.825616, 10.7667, 0.309525, -1.0699,
+		 Phase::Gas},
+		{6000, 20000, -8.468, 0,
+		 214.865, 101.423, -3.64108, 38.5109, -41.3816, 5.11958, -0.322478,
+		 Phase::Gas},
+	}, {{1, 2}});
+	system.Add(2004, "H2O1(g)", 18.0153, {
+		{298.15, 1500, -251.722, 0,
+		 253.982, 27.18, 0.000985057, -0.184676, 69.0495, 28.8288, -115.537,
+		 Phase::Gas},
+		{1500, 6000, -251.722, 0,
+		 263.916, 35.3576, -0.0339592, 1.15054, 64.3125, -37.3939, 13.002,
+		 Phase::Gas},
+		{6000, 20000, -251.722, 0,
+		 347.677, 250.176, -9.19942, 102.01, -167.885, 35.7005, -3.97623,
+		 Phase::Gas},
+	}, {{1, 2}, {8, 1}});
+	system.Add(2007, "H1O1(g)", 17.0073, {
+		{298.15, 1500, 30.522, 0,
+		 266.987, 32.1263, -3.45076e-05, 0.0416197, -53.9322, 215.125, -297.239,
+		 Phase::Gas},
+		{1500, 6000, 30.522, 0,
+		 259.214, 33.4929, -0.0298877, 1.00973, 6.35371, 1.69693, -1.66089,
+		 Phase::Gas},
+		{6000, 20000, 30.522, 0,
+		 269.187, 83.7263, -2.49789, 27.3681, -31.0655, 3.80064, -0.241857,
+		 Phase::Gas},
+	}, {{1, 1}, {8, 1}});
+	system.Add(2542, "O1(g)", 15.9994, {
+		{298.15, 1500, 242.445, 0,
+		 215.419, 21.3814, 0.000366195, -0.0643666, -6.22227, 15.9471, -21.1655,
+		 Phase::Gas},
+		{1500, 6000, 242.445, 0,
+		 217.297, 22.7493, -0.00433948, 0.133595, -7.94626, 7.10449, -2.41763,
+		 Phase::Gas},
+		{6000, 20000, 242.445, 0,
+		 211.009, 21.7631, -0.212924, 1.58133, 2.38508, -0.630479, 0.0671619,
+		 Phase::Gas},
+	}, {{8, 1}});
+	system.Add(2543, "O2(g)", 31.9988, {
+		{298.15, 1500, -8.682, 0,
+		 249.211, 20.1504, 0.00103248, -0.2266, 140.388, -295.3, 347.686,
+		 Phase::Gas},
+		{1500, 6000, -8.682, 0,
+		 278.618, 29.9343, 0.00781359, -0.0669831, 23.9328, -9.855, 2.57379,
+		 Phase::Gas},
+		{6000, 20000, -8.682, 0,
+		 290.712, 86.2171, -3.00455, 30.5095, -25.5949, 2.32299, -0.0502174,
+		 Phase::Gas},
+	}, {{8, 2}});
+	return system;
+}
+
+// B, Ti, TiB and TiB2, solid and liquid, elements B = 5, Ti = 22
+inline System TitaniumBoron()
+{
+	System system;
+	system.elements = {5, 22};
+	system.Add(250, "B1(s)", 10.811, {
+		{298.15, 2348, -1.222, 0,
+		 34.7956, 14.9204, -0.00360314, 0.63071, 80.8357, -108.241, 87.729,
+		 Phase::Solid},
+	}, {{5, 1}});
+	system.Add(251, "B1(l)", 10.811, {
+		{298.15, 6000, -1.222, 0,
+		 88.2327, 31.3925, 0, -3.00533, 0, 0, 0,
+		 Phase::Liquid},
+	}, {{5, 1}});
+	system.Add(389, "B2Ti1(l)", 69.502, {
+		{298.15, 6000, -279.432, 0,
+		 257.1, 108.758, 0, -0.52691, 0, 0, 0,
+		 Phase::Liquid},
+	}, {{5, 2}, {22, 1}});
+	system.Add(390, "B1Ti1(s)", 58.691, {
+		{298.15, 4000, -160.313, 0,
+		 181.927, 63.5565, -0.015017, 2.83189, -72.6462, 111.201, -72.002,
+		 Phase::Solid},
+	}, {{5, 1}, {22, 1}});
+	system.Add(391, "B2Ti1(s)", 69.502, {
+		{298.15, 3193, -279.432, 0,
+		 161.43, 59.612, -0.009833, 2.5225, 97.1859, 12.8955, -68.52,
+		 Phase::Solid},
+	}, {{5, 2}, {22, 1}});
+	system.Add(2954, "Ti1(s)", 47.88, {
+		{298.15, 900, -4.824, 0,
+		 144.291, 40.561, -0.0022095, 0.683385, -304.81, 1676.2, -4070.75,
+		 Phase::Solid},
+		{900, 1156, -4.824, 0,
+		 441.698, 154.435, 0, 4.82579, -1013.88, 0, 6751.83,
+		 Phase::Solid},
+		{1156, 1944, -4.824, 0,
+		 84.1585, 16.908, 0, -0.963218, 29.42, 53.2, 0,
+		 Phase::Solid},
+	}, {{22, 1}});
+	system.Add(2955, "Ti1(l)", 47.88, {
+		{298.15, 5600, -4.824, 0,
+		 128.205, 46.8, 0, 1.49422, 0, 0, 0,
+		 Phase::Liquid},
+	}, {{22, 1}});
+	return system;
+}
+
+// Ar gas, element Ar = 18
+inline System Argon()
+{
+	System system;
+	system.elements = {18};
+	system.Add(202, "Ar1(g)", 39.948, {
+		{298.15, 6000, -6.197, 0,
+		 206.965, 20.786, -1.35483e-09, 1.42315e-07, -1.21723e-05, 9.3563e-07, 3.72523e-06,
+		 Phase::Gas},
+		{6000, 20000, -6.197, 0,
+		 198.242, 3.13694, 0.618604, -7.45164, 20.574, -5.91438, 0.89719,
+		 Phase::Gas},
+	}, {{18, 1}});
+	return system;
+}
+
+// The systems without common substances in one
+inline System Join(const System& lhs, const System& rhs)
+{
+	System system = lhs;
+	system.elements.insert(system.elements.end(), rhs.elements.cbegin(),
+						   rhs.elements.cend());
+	std::sort(system.elements.begin(), system.elements.end());
+	system.elements.erase(std::unique(system.elements.begin(), system.elements.end()),
+						  system.elements.end());
+	for(const auto& weight : rhs.weights) {
+		system.weights.push_back(weight);
+	}
+	std::sort(system.weights.begin(), system.weights.end(),
+			  [](const SubstanceWeight& a, const SubstanceWeight& b){ return a.id < b.id; });
+	system.temp_ranges.insert(rhs.temp_ranges.cbegin(), rhs.temp_ranges.cend());
+	system.subs_element_composition.insert(rhs.subs_element_composition.cbegin(),
+										   rhs.subs_element_composition.cend());
+	system.amounts.insert(rhs.amounts.cbegin(), rhs.amounts.cend());
+	GetSumAndRecalculate(system.amounts);
+	return system;
+}
+
+#endif // SYSTEMS_H
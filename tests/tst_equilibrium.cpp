@@ -0,0 +1,186 @@
+/* This file is part of ATC (Adiabatic Temperature Calculator).
+ * Copyright (c) 2025 Alexandr Shchukin
+ * Corresponding email: shchukin.aleksandr.sergeevich@gmail.com
+ *
+ * ATC (Adiabatic Temperature Calculator) is free software:
+ * you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * ATC (Adiabatic Temperature Calculator) is distributed in the hope that
+ * it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ATC (Adiabatic Temperature Calculator).
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QTest>
+#include "optimization.h"
+#include "systems.h"
+
+using ParametersNS::EquilibriumSolver;
+using ParametersNS::Decomposition;
+
+class TestEquilibrium : public QObject
+{
+	Q_OBJECT
+private slots:
+	void ElementPotentials();
+	void Dual();
+	void ActiveSet();
+	void ActiveSetAddsSpecies();
+	void Blocks();
+	void BlocksWithInertGas();
+};
+
+// Equilibria of the system in the temperature range by the solver
+static Optimization::OptimizationVector Calculate(
+		const System& system, const ParametersNS::Range& range,
+		const EquilibriumSolver solver,
+		const Decomposition decomposition = Decomposition::Disable)
+{
+	ParametersNS::Parameters parameters;
+	parameters.workmode = ParametersNS::Workmode::TemperatureRange;
+	parameters.target = ParametersNS::Target::Equilibrium;
+	parameters.temperature_range = range;
+	parameters.equilibrium_solver = solver;
+	parameters.decomposition = decomposition;
+	Optimization::OptimizationItemsMaker maker(parameters, system.elements,
+			system.temp_ranges, system.subs_element_composition, system.weights,
+			system.amounts);
+	auto items = std::move(maker.GetData());
+	for(auto&& item : items) {
+		item.Calculate();
+	}
+	return items;
+}
+
+// Moles of the element in the amounts
+static double Element(const System& system, const Composition& amounts,
+					  const int element)
+{
+	double sum{0.0};
+	for(const auto& [id, amount] : amounts) {
+		auto&& composition = system.subs_element_composition.at(id);
+		auto it = composition.find(element);
+		if(it != composition.cend()) {
+			sum += it->second * amount.sum_mol;
+		}
+	}
+	return sum;
+}
+
+// The solver keeps the elements and its G is not above G of nlopt,
+// G is G/RT of the equilibrium
+static void CompareWithNLopt(const System& system,
+							 const ParametersNS::Range& range,
+							 const EquilibriumSolver solver,
+							 const Decomposition decomposition = Decomposition::Disable)
+{
+	auto reference = Calculate(system, range, EquilibriumSolver::NLopt);
+	auto items = Calculate(system, range, solver, decomposition);
+	QCOMPARE(items.size(), reference.size());
+	for(size_t i = 0; i != items.size(); ++i) {
+		auto&& item = items[i];
+		for(const auto element : system.elements) {
+			const double initial = Element(system, system.amounts, element);
+			const double equilibrium = Element(system, item.amounts_of_equilibrium,
+											   element);
+			QVERIFY2(std::abs(equilibrium - initial) <= 1e-6 * initial,
+					 qPrintable(QString("element %1: %2 != %3").arg(element)
+								.arg(equilibrium).arg(initial)));
+		}
+		const double G = item.result_of_optimization;
+		const double G_nlopt = reference[i].result_of_optimization;
+		QVERIFY2(G <= G_nlopt + 1e-6 * (1 + std::abs(G_nlopt)),
+				 qPrintable(QString("G %1 > %2").arg(G).arg(G_nlopt)));
+	}
+}
+
+static System Gas()
+{
+	auto system = HydrogenOxygen();
+	system.SetAmount(1931, 2);	// H2
+	system.SetAmount(2543, 1);	// O2
+	return system;
+}
+
+static System Condensed()
+{
+	auto system = TitaniumBoron();
+	system.SetAmount(2954, 1);	// Ti
+	system.SetAmount(250, 1.5);	// B
+	return system;
+}
+
+static System Mixed()
+{
+	auto system = CarbonOxygen();
+	system.SetAmount(713, 2);	// C
+	system.SetAmount(2543, 1);	// O2
+	return system;
+}
+
+void TestEquilibrium::ElementPotentials()
+{
+	CompareWithNLopt(Gas(), {2000, 4000, 250}, EquilibriumSolver::ElementPotentials);
+	CompareWithNLopt(Condensed(), {2000, 3500, 250}, EquilibriumSolver::ElementPotentials);
+	CompareWithNLopt(Mixed(), {500, 2500, 250}, EquilibriumSolver::ElementPotentials);
+}
+
+void TestEquilibrium::Dual()
+{
+	CompareWithNLopt(Gas(), {2000, 4000, 250}, EquilibriumSolver::Dual);
+	CompareWithNLopt(Condensed(), {2000, 3500, 250}, EquilibriumSolver::Dual);
+	CompareWithNLopt(Mixed(), {500, 2500, 250}, EquilibriumSolver::Dual);
+}
+
+void TestEquilibrium::ActiveSet()
+{
+	CompareWithNLopt(Gas(), {2000, 4000, 250}, EquilibriumSolver::ActiveSet);
+	CompareWithNLopt(Condensed(), {2000, 3500, 250}, EquilibriumSolver::ActiveSet);
+	CompareWithNLopt(Mixed(), {500, 2500, 250}, EquilibriumSolver::ActiveSet);
+}
+
+void TestEquilibrium::ActiveSetAddsSpecies()
+{
+	// the linearized problem gives CO alone, C(s) is added by the test
+	// of the active set
+	const auto system = Mixed();
+	const ParametersNS::Range range{1000, 1100, 50};
+	CompareWithNLopt(system, range, EquilibriumSolver::ActiveSet);
+	for(auto&& item : Calculate(system, range, EquilibriumSolver::ActiveSet)) {
+		auto it = item.amounts_of_equilibrium.find(713);
+		QVERIFY(it != item.amounts_of_equilibrium.cend() && it->second.sum_mol > 0.1);
+	}
+}
+
+void TestEquilibrium::Blocks()
+{
+	// Ti-B without the liquids is solved alone, C-O has the gas
+	auto condensed = Condensed();
+	for(const auto id : {251, 389, 2955}) {
+		condensed.Remove(id);
+	}
+	const auto system = Join(Mixed(), condensed);
+	CompareWithNLopt(system, {1000, 2000, 250}, EquilibriumSolver::NLopt,
+					 Decomposition::Enable);
+}
+
+void TestEquilibrium::BlocksWithInertGas()
+{
+	// Ar is fixed by its element and dilutes the gas of C-O
+	auto argon = Argon();
+	argon.SetAmount(202, 3);
+	const auto system = Join(Mixed(), argon);
+	CompareWithNLopt(system, {1000, 2000, 250}, EquilibriumSolver::NLopt,
+					 Decomposition::Enable);
+}
+
+QTEST_APPLESS_MAIN(TestEquilibrium)
+
+#include "tst_equilibrium.moc"
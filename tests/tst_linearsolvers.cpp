@@ -0,0 +1,127 @@
+/* This file is part of ATC (Adiabatic Temperature Calculator).
+ * Copyright (c) 2025 Alexandr Shchukin
+ * Corresponding email: shchukin.aleksandr.sergeevich@gmail.com
+ *
+ * ATC (Adiabatic Temperature Calculator) is free software:
+ * you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * ATC (Adiabatic Temperature Calculator) is distributed in the hope that
+ * it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ATC (Adiabatic Temperature Calculator).
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QTest>
+#include "optimization.h"
+#include <numeric>
+
+class TestLinearSolvers : public QObject
+{
+	Q_OBJECT
+private slots:
+	void NonNegativeLeastSquares();
+	void SimplexDegenerate();
+	void SimplexInfeasible();
+	void SimplexUpperBounds();
+};
+
+static bool IsNear(const std::vector<double>& x, const std::vector<double>& expected,
+				   const double epsilon = 1e-10)
+{
+	return x.size() == expected.size() &&
+			std::equal(x.cbegin(), x.cend(), expected.cbegin(),
+					   [epsilon](const double a, const double b){
+		return std::abs(a - b) <= epsilon; });
+}
+
+void TestLinearSolvers::NonNegativeLeastSquares()
+{
+	using Optimization::NonNegativeLeastSquares;
+	std::vector<double> y;
+
+	// consistent, the solution is positive: 2 (1, 2, 0) + 3 (0, 1, 1)
+	QVERIFY(NonNegativeLeastSquares({1, 2, 0, 0, 1, 1}, {2, 7, 3}, 3, 2, y));
+	QVERIFY(IsNear(y, {2, 3}));
+
+	// line c1 + c2 x through (1, 3), (2, 2), (3, 1) has c2 = -1,
+	// with c2 >= 0 it is the mean 2
+	QVERIFY(NonNegativeLeastSquares({1, 1, 1, 1, 2, 3}, {3, 2, 1}, 3, 2, y));
+	QVERIFY(IsNear(y, {2, 0}));
+
+	// columns (1, 0), (0, 1), (1, 1) and rhs (1, -1), only the first column
+	// is used, the gradient of the others at the solution is -1
+	QVERIFY(NonNegativeLeastSquares({1, 0, 0, 1, 1, 1}, {1, -1}, 2, 3, y));
+	QVERIFY(IsNear(y, {1, 0, 0}));
+
+	// rhs in the negative cone gives zero
+	QVERIFY(NonNegativeLeastSquares({1, 0, 0, 1}, {-1, -2}, 2, 2, y));
+	QVERIFY(IsNear(y, {0, 0}));
+}
+
+static constexpr double no_bound = std::numeric_limits<double>::max();
+
+void TestLinearSolvers::SimplexDegenerate()
+{
+	// Beale's example, the vertices are degenerate and the simplex method
+	// with the largest reduced cost cycles on it
+	Optimization::SimplexSolver solver;
+	const std::vector<double> a{
+		1, 0, 0, 0.25,  -8,   -1, 9,
+		0, 1, 0, 0.5,  -12, -0.5, 3,
+		0, 0, 1, 0,      0,    1, 0};
+	const std::vector<double> cost{0, 0, 0, -0.75, 20, -0.5, 6};
+	const std::vector<double> ub(7, no_bound);
+	std::vector<double> x(7);
+	QVERIFY(solver.Solve(a.data(), 3, 7, {0, 0, 1}, cost, ub, x));
+	QVERIFY(IsNear(x, {0.75, 0, 0, 1, 0, 1, 0}));
+	QVERIFY(std::abs(std::inner_product(x.cbegin(), x.cend(),
+										cost.cbegin(), 0.0) + 1.25) < 1e-10);
+}
+
+void TestLinearSolvers::SimplexInfeasible()
+{
+	Optimization::SimplexSolver solver;
+	std::vector<double> x(2);
+	// x1 + x2 = 1 and x1 + x2 = 2
+	QVERIFY(!solver.Solve(std::vector<double>{1, 1, 1, 1}.data(), 2, 2, {1, 2},
+						  {1, 1}, {no_bound, no_bound}, x));
+	// x1 + x2 = -1 with x >= 0
+	QVERIFY(!solver.Solve(std::vector<double>{1, 1}.data(), 1, 2, {-1},
+						  {1, 1}, {no_bound, no_bound}, x));
+	// x1 + x2 = 3 with x1 <= 1, x2 <= 1
+	QVERIFY(!solver.Solve(std::vector<double>{1, 1}.data(), 1, 2, {3},
+						  {1, 1}, {1, 1}, x));
+}
+
+void TestLinearSolvers::SimplexUpperBounds()
+{
+	Optimization::SimplexSolver solver;
+	std::vector<double> x(3);
+	// min -x1 - 2 x2, x1 + x2 + x3 = 4, x1 <= 3, x2 <= 1,
+	// the nonbasic x2 stays at its bound
+	QVERIFY(solver.Solve(std::vector<double>{1, 1, 1}.data(), 1, 3, {4},
+						 {-1, -2, 0}, {3, 1, no_bound}, x));
+	QVERIFY(IsNear(x, {3, 1, 0}));
+
+	// min -x2, x1 - x2 + x3 = 1, x1 <= 2, x3 <= 1,
+	// the basic x1 rises to its bound and leaves the basis
+	QVERIFY(solver.Solve(std::vector<double>{1, -1, 1}.data(), 1, 3, {1},
+						 {0, -1, 0}, {2, no_bound, 1}, x));
+	QVERIFY(IsNear(x, {2, 2, 1}));
+
+	// the column with ub = 0 is fixed at zero
+	QVERIFY(solver.Solve(std::vector<double>{1, 1}.data(), 1, 2, {2},
+						 {-1, 0}, {0, no_bound}, x));
+	QVERIFY(IsNear(std::vector<double>(x.cbegin(), x.cbegin() + 2), {0, 2}));
+}
+
+QTEST_APPLESS_MAIN(TestLinearSolvers)
+
+#include "tst_linearsolvers.moc"
@@ -0,0 +1,121 @@
+/* This file is part of ATC (Adiabatic Temperature Calculator).
+ * Copyright (c) 2025 Alexandr Shchukin
+ * Corresponding email: shchukin.aleksandr.sergeevich@gmail.com
+ *
+ * ATC (Adiabatic Temperature Calculator) is free software:
+ * you can redistribute it and/or modify it under the terms of
+ * the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * ATC (Adiabatic Temperature Calculator) is distributed in the hope that
+ * it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with ATC (Adiabatic Temperature Calculator).
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QTest>
+#include "optimization.h"
+#include "systems.h"
+
+using Thermodynamics::PropertiesBlock;
+
+class TestSurrogate : public QObject
+{
+	Q_OBJECT
+private slots:
+	void AgreesWithExactFunctions();
+};
+
+// The surrogate is compared with the exact functions of the intervals
+// between the check points of the fit, the errors of G, S and F are
+// the errors of c (or S) and H carried through their relations.
+void TestSurrogate::AgreesWithExactFunctions()
+{
+	auto system = CarbonOxygen();
+	system.SetAmount(713, 1);
+	system.SetAmount(2543, 1);
+	for(auto function : {ParametersNS::MinimizationFunction::GibbsEnergy,
+		 ParametersNS::MinimizationFunction::Entropy}) {
+		for(int accuracy : {6, 10}) {
+			ParametersNS::Parameters parameters;
+			parameters.target = ParametersNS::Target::AdiabaticTemperature;
+			parameters.minimization_function = function;
+			parameters.surrogate = ParametersNS::Surrogate::Enable;
+			parameters.surrogate_accuracy = accuracy;
+			const Optimization::ProblemContext context(parameters,
+					system.elements, system.temp_ranges,
+					system.subs_element_composition, system.weights,
+					system.amounts);
+			QVERIFY(context.surrogate.Size() > 0);
+			const auto c = function == ParametersNS::MinimizationFunction::GibbsEnergy
+					? &PropertiesBlock::c : &PropertiesBlock::S_J;
+			const size_t N = context.substance_ids.size();
+			const double T_min = Optimization::EnthalpyCurve::T_min;
+			const double T_max = Optimization::EnthalpyCurve::T_max;
+			const size_t points = 2000;
+
+			std::vector<PropertiesBlock> exact(points);
+			std::vector<double> scale_c(N, 0.0), scale_H(N, 0.0), scale_Cp(N, 0.0);
+			for(size_t i = 0; i != points; ++i) {
+				const double T = T_min + (T_max - T_min) * (i + 0.37) / points;
+				auto&& interval = context.FindInterval(T);
+				exact[i].Resize(N);
+				for(size_t k = 0; k != N; ++k) {
+					auto p = Thermodynamics::Thermo::TF_Properties(T, *interval.coefs[k]);
+					exact[i].Set(k, p);
+					scale_c[k] = std::max(scale_c[k], std::abs((exact[i].*c)[k]));
+					scale_H[k] = std::max(scale_H[k], std::abs(p.H_kJ));
+					scale_Cp[k] = std::max(scale_Cp[k], std::abs(p.Cp_J));
+				}
+			}
+
+			const double tolerance = 10 * std::pow(10.0, -accuracy);
+			size_t evaluated = 0;
+			PropertiesBlock approximation;
+			approximation.Resize(N);
+			for(size_t i = 0; i != points; ++i) {
+				const double T = T_min + (T_max - T_min) * (i + 0.37) / points;
+				if(!context.surrogate.Evaluate(T, c, approximation)) {
+					continue;
+				}
+				++evaluated;
+				auto&& e = exact[i];
+				auto&& a = approximation;
+				const double RT = Thermodynamics::R * T;
+				for(size_t k = 0; k != N; ++k) {
+					const double error_c = tolerance * scale_c[k];
+					const double error_H = tolerance * scale_H[k];
+					const double error_G = c == &PropertiesBlock::c
+							? error_c * RT * 1.0E-03
+							: error_H + T * error_c * 1.0E-03;
+					const double error_S = c == &PropertiesBlock::c
+							? (error_H + error_G) * 1.0E+03 / T : error_c;
+					QVERIFY2(std::abs(a.c[k] - e.c[k]) <=
+							 (c == &PropertiesBlock::c ? error_c : error_G * 1.0E+03 / RT),
+							 qPrintable(QString("c, T = %1, k = %2").arg(T).arg(k)));
+					QVERIFY2(std::abs(a.H_kJ[k] - e.H_kJ[k]) <= error_H,
+							 qPrintable(QString("H, T = %1, k = %2").arg(T).arg(k)));
+					QVERIFY2(std::abs(a.Cp_J[k] - e.Cp_J[k]) <= tolerance * scale_Cp[k],
+							 qPrintable(QString("Cp, T = %1, k = %2").arg(T).arg(k)));
+					QVERIFY2(std::abs(a.G_kJ[k] - e.G_kJ[k]) <= error_G,
+							 qPrintable(QString("G, T = %1, k = %2").arg(T).arg(k)));
+					QVERIFY2(std::abs(a.S_J[k] - e.S_J[k]) <= error_S,
+							 qPrintable(QString("S, T = %1, k = %2").arg(T).arg(k)));
+					QVERIFY2(std::abs(a.F_J[k] - e.F_J[k]) <= error_G * 1.0E+03 / T,
+							 qPrintable(QString("F, T = %1, k = %2").arg(T).arg(k)));
+				}
+			}
+			// only a few pieces can be calculated by the exact functions
+			QVERIFY(evaluated > points * 9 / 10);
+		}
+	}
+}
+
+QTEST_APPLESS_MAIN(TestSurrogate)
+
+#include "tst_surrogate.moc"